@@ -0,0 +1,123 @@
+// Favorites Bulk Benchmark: What saving My List costs per click. 10,000 cities are added to My List in
+// one click and removed in another, then single cities are added and removed while 10,000 favorites
+// are listed. Each is done once with the journal (addToMyCityList / removeFromMyList append their
+// changes) and once rewriting favorites.txt on every click, as before the journal. Compaction, when
+// the journal outgrows the list, is part of the journalled times.
+// Writes favorites.txt and favorites.journal in the current directory, so it refuses to run where they exist.
+// Usage: favorites_bulk_bench [favorites, default 10000]
+#include "MusaWeatherApp.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+
+const int single_clicks = 200;
+const double frame_ms = 1000.0 / 60.0;
+
+typedef void (*SaveFavorites)(std::set<std::string>& favorites);
+
+double millisecondsSince(std::chrono::steady_clock::time_point started) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+}
+
+void selectOnly(size_t first, size_t last) {
+    size_t i = 0;
+    for (auto& city : cities) {
+        city.selected = i >= first && i < last;
+        i++;
+    }
+}
+
+// Each click as main.cpp handles it now: the change goes to the journal
+void addJournalled(std::set<std::string>& favorites) {
+    addToMyCityList(cities, favorites);
+}
+
+void removeJournalled(std::set<std::string>& favorites) {
+    removeFromMyList(cities, favorites);
+}
+
+// Each click as before the journal: the set changes, then the whole file is rewritten
+void addRewriting(std::set<std::string>& favorites) {
+    for (const auto& city : cities) {
+        if (city.selected) {
+            favorites.insert(city.name);
+        }
+    }
+    saveMyCityList(cities, favorites);
+}
+
+void removeRewriting(std::set<std::string>& favorites) {
+    for (const auto& city : cities) {
+        if (city.selected) {
+            favorites.erase(city.name);
+        }
+    }
+    saveMyCityList(cities, favorites);
+}
+
+double percentile(std::vector<double> values, double p) {
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(p / 100.0 * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void run(const char* name, size_t count, SaveFavorites add, SaveFavorites remove) {
+    std::remove(favorites_file.c_str());
+    std::remove(favorites_journal_file.c_str());
+    favoritesJournalRecords = 0;
+    std::set<std::string> favorites;
+
+    // Bulk: every one of `count` cities in one click, then out again in another
+    selectOnly(0, count);
+    auto started = std::chrono::steady_clock::now();
+    add(favorites);
+    double bulkAddMs = millisecondsSince(started);
+    started = std::chrono::steady_clock::now();
+    remove(favorites);
+    double bulkRemoveMs = millisecondsSince(started);
+
+    // Single clicks with `count` favorites listed: one more city added, then removed again
+    add(favorites);
+    std::vector<double> clickMs;
+    for (int click = 0; click < single_clicks; click++) {
+        size_t extra = count + click % count;
+        selectOnly(extra, extra + 1);
+        started = std::chrono::steady_clock::now();
+        add(favorites);
+        clickMs.push_back(millisecondsSince(started));
+        started = std::chrono::steady_clock::now();
+        remove(favorites);
+        clickMs.push_back(millisecondsSince(started));
+    }
+    bool listed = favorites.size() == count;
+
+    std::printf("%-22s %12.1f %12.1f %10.2f %10.2f %10.2f%s\n", name, bulkAddMs, bulkRemoveMs, percentile(clickMs, 50.0),
+        percentile(clickMs, 99.0), *std::max_element(clickMs.begin(), clickMs.end()), listed ? "" : "  (wrong result)");
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 10000;
+    if (std::ifstream(favorites_file).is_open() || std::ifstream(favorites_journal_file).is_open()) {
+        std::fprintf(stderr, "%s or %s exists here; run this in an empty directory\n", favorites_file.c_str(),
+            favorites_journal_file.c_str());
+        return 1;
+    }
+    cities.clear();
+    for (size_t i = 0; i < 2 * count; i++) {
+        cities.add(City("City " + std::to_string(i), -179.0 + (i / 160) * 0.05, -80.0 + (i % 160)));
+    }
+
+    std::printf("%zu favorites; bulk clicks and %d single add/remove pairs, ms (a 60 Hz frame is %.1f ms)\n\n", count,
+        single_clicks, frame_ms);
+    std::printf("%-22s %12s %12s %10s %10s %10s\n", "saved by", "bulk add", "bulk remove", "click p50", "click p99", "click max");
+    run("journal", count, addJournalled, removeJournalled);
+    run("rewrite (before)", count, addRewriting, removeRewriting);
+    std::remove(favorites_file.c_str());
+    std::remove(favorites_journal_file.c_str());
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Fetch Throughput Benchmark: "See Weather" for 100, 1,000 and 10,000 cities against a local mock of
+// the OpenWeatherMap API. Each size runs through the worker pool (startWeatherBatch, results collected
+// the way the frame loop does) and, for comparison, with one thread per city as before the pool: each
+// thread opens its own client and sends its request at once, with no rate limiter or connection reuse.
+// Usage: fetch_throughput_bench [mock latency in ms, default 2]
+#include "MusaWeatherApp.h"
+#include "MockWeatherApi.h"
+#include "httplib.h"
+#include <cstdio>
+#include <cstdlib>
+#include <system_error>
+
+namespace {
+
+struct RunResult {
+    double seconds;
+    size_t withWeather;
+    size_t requests;
+    size_t connections;
+    const char* note;
+};
+
+// Function to Fill the Registry with `count` Cities whose locations no earlier run has used,
+// so every one is a cache miss fetched by coordinates
+void fillCities(size_t count, int run) {
+    cities.clear();
+    for (size_t i = 0; i < count; i++) {
+        double lat = -80.0 + static_cast<double>(i % 160) + 0.013 * run;
+        double lon = -179.0 + static_cast<double>(i / 160) * 0.05;
+        cities.add({ "City " + std::to_string(i), lon, lat, false });
+    }
+}
+
+size_t citiesWithWeather() {
+    size_t count = 0;
+    for (const auto& city : cities) {
+        if (city.weatherData.valid) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Function to Time One Batch through fetchPool
+RunResult runPooled() {
+    HttpClientPool::Stats before = apiClientPool.stats();
+    auto started = std::chrono::steady_clock::now();
+    std::vector<City*> targets;
+    for (auto& city : cities) {
+        targets.push_back(&city);
+    }
+    std::shared_ptr<WeatherBatch> batch = startWeatherBatch(targets);
+    while (!batch->done()) {
+        cities.collectWeather();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Stands in for a frame
+    }
+    cities.collectWeather();
+    HttpClientPool::Stats after = apiClientPool.stats();
+    RunResult result = { std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count(),
+        citiesWithWeather(), after.requests - before.requests, after.connectionsOpened - before.connectionsOpened, "" };
+    return result;
+}
+
+// Function to Fetch One City the way each thread did before the pool: a fresh client, one GET, no
+// rate limiter, retries or shared connections
+void fetchOnOwnClient(const WeatherTarget& target, const std::string& host, const std::shared_ptr<CancellationToken>& token) {
+    if (token->isCancelled()) {
+        return;
+    }
+    httplib::Client client(host);
+    client.set_read_timeout(default_request_policy.deadline);
+    std::string url = "/data/2.5/weather?lat=" + std::to_string(target.lat) + "&lon=" + std::to_string(target.lon) + "&appid=" + api_key;
+    auto res = client.Get(url.c_str());
+    WeatherSnapshot snapshot;
+    if (res && res->status == 200 && WeatherSnapshot::parse(res->body, snapshot)) {
+        cities.deliverWeather(target.city, snapshot, token);
+    }
+}
+
+// Function to Time One Batch the old way: one OS thread per city, all joined at the end. The batch is
+// cancelled after `limit` in case the machine cannot keep that many connections open at once.
+RunResult runThreadPerCity(const MockWeatherApi& mock, std::chrono::seconds limit) {
+    size_t requestsBefore = mock.requests();
+    auto started = std::chrono::steady_clock::now();
+    std::shared_ptr<CancellationToken> token = std::make_shared<CancellationToken>();
+    std::shared_ptr<CancellationToken> finished = std::make_shared<CancellationToken>();
+    std::thread watchdog([token, finished, limit]() {
+        if (!finished->waitFor(limit)) {
+            token->cancel();
+        }
+        });
+    std::vector<std::thread> threads;
+    const char* note = "";
+    for (auto& city : cities) {
+        WeatherTarget target = { city.handle, city.name, city.lat, city.lon, city.owmId };
+        try {
+            threads.emplace_back(fetchOnOwnClient, target, mock.host(), token);
+        }
+        catch (const std::system_error& e) {
+            std::fprintf(stderr, "Thread %zu could not be started: %s\n", threads.size() + 1, e.what());
+            note = "  (not every thread started)";
+            break;
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    finished->cancel();
+    watchdog.join();
+    if (token->isCancelled()) {
+        note = "  (cancelled at the time limit)";
+    }
+    cities.collectWeather();
+    size_t requests = mock.requests() - requestsBefore;
+    RunResult result = { std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count(),
+        citiesWithWeather(), requests, requests, note }; // Every request opened its own connection
+    return result;
+}
+
+void report(size_t count, const char* mode, const RunResult& result) {
+    std::printf("%7zu  %-16s %8.3f %10.0f %9zu %9zu %12zu%s\n", count, mode, result.seconds,
+        result.withWeather / result.seconds, result.withWeather, result.requests, result.connections,
+        result.note);
+}
+
+}
+
+int main(int argc, char** argv) {
+    long latencyMs = argc > 1 ? std::atol(argv[1]) : 2;
+    MockLatency latency = { std::chrono::milliseconds(latencyMs), std::chrono::milliseconds(latencyMs), 0.0, 0.0 };
+    MockWeatherApi mock(latency);
+    if (!mock.start()) {
+        std::fprintf(stderr, "Could not start the mock API\n");
+        return 1;
+    }
+    api_key = "benchmark";
+    apiClientPool.setHost(mock.host());
+    apiRateLimiter.setRate(1e9); // The mock has no quota; the concurrency cap still applies
+
+    std::printf("Mock latency %ld ms, %zu fetch workers\n\n", latencyMs, fetchPool.maxWorkers());
+    std::printf("%7s  %-16s %8s %10s %9s %9s %12s\n", "cities", "mode", "seconds", "cities/s", "weather", "requests", "connections");
+    const size_t sizes[] = { 100, 1000, 10000 };
+    int run = 0;
+    for (size_t count : sizes) {
+        fillCities(count, run++);
+        report(count, "worker pool", runPooled());
+        fillCities(count, run++);
+        report(count, "thread per city", runThreadPerCity(mock, std::chrono::seconds(60)));
+    }
+    cities.clear();
+    mock.stop();
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Lookup Frame Benchmark: Frame times while "Add Place" and "Add Random City" wait on the geocoding API,
+// in a headless ImGui context paced to 60 Hz the way vsync paces the app. The city list is drawn every
+// frame as main.cpp draws it. Each lookup once runs on the UI thread, as validateCity did before the
+// lookups became jobs, and once through startCityLookup / startReverseLookup, polled every frame.
+// No gazetteer is opened, so every lookup is a round trip to a local mock API. Lookups go through
+// apiRateLimiter as in the app (60 a minute after a burst of 10), so once the burst is spent they
+// also wait for a token; that wait stretches the run, not the frames.
+// Usage: lookup_frame_bench [mock latency ms, default 300]
+#include "MusaWeatherApp.h"
+#include "MockWeatherApi.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+namespace {
+
+const size_t listed_cities = 1000;
+const int lookups = 10;
+const std::chrono::microseconds frame_interval(16667); // 60 Hz
+const double missed_frame_ms = 1000.0 / 60.0 * 1.5; // A gap this long means vsync was missed at least once
+
+struct FrameTimes {
+    std::vector<double> workMs; // NewFrame to Render
+    std::vector<double> gapMs;  // Start of one frame to the start of the next
+    double lookupSeconds;
+};
+
+double percentile(std::vector<double> values, double p) {
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(p / 100.0 * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void drawCityList() {
+    ImGui::Begin("Cities");
+    ImGui::BeginChild("City Selection", ImVec2(0, 500.0f), true);
+    for (auto& city : cities) {
+        ImGui::Checkbox(city.name.c_str(), &city.selected);
+    }
+    ImGui::EndChild();
+    ImGui::End();
+}
+
+// Function to Run Frames until `lookups` lookups have finished. `step` is called once per frame, after
+// NewFrame, with the number of the lookup to start or poll; it returns true once that lookup is done.
+FrameTimes runFrames(const std::function<bool(int)>& step) {
+    FrameTimes times = { std::vector<double>(), std::vector<double>(), 0.0 };
+    auto started = std::chrono::steady_clock::now();
+    auto previous = started;
+    auto nextFrame = started;
+    int done = 0;
+    for (int frame = 0; done < lookups; frame++) {
+        auto frameStart = std::chrono::steady_clock::now();
+        if (frame > 0) {
+            times.gapMs.push_back(std::chrono::duration<double, std::milli>(frameStart - previous).count());
+        }
+        previous = frameStart;
+        ImGui::GetIO().DeltaTime = 1.0f / 60.0f;
+        ImGui::NewFrame();
+        if (step(done)) {
+            done++;
+        }
+        drawCityList();
+        ImGui::Render();
+        times.workMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+        nextFrame += frame_interval;
+        std::this_thread::sleep_until(nextFrame); // Stands in for glfwSwapBuffers waiting on vsync
+        nextFrame = std::max(nextFrame, std::chrono::steady_clock::now());
+    }
+    times.lookupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return times;
+}
+
+void report(const char* name, const FrameTimes& times) {
+    size_t missed = std::count_if(times.gapMs.begin(), times.gapMs.end(), [](double gap) { return gap > missed_frame_ms; });
+    std::printf("%-36s %7zu %8.2f %8.2f %9.1f %9.1f %7zu\n", name, times.workMs.size(), percentile(times.workMs, 50.0),
+        percentile(times.workMs, 99.0), *std::max_element(times.workMs.begin(), times.workMs.end()),
+        *std::max_element(times.gapMs.begin(), times.gapMs.end()), missed);
+}
+
+std::string lookupName(const char* prefix, int i) {
+    return std::string(prefix) + std::to_string(i); // No spaces: the app does not encode the query
+}
+
+}
+
+int main(int argc, char** argv) {
+    int latencyMs = argc > 1 ? std::atoi(argv[1]) : 300;
+    MockLatency latency = { std::chrono::milliseconds(latencyMs), std::chrono::milliseconds(latencyMs), 0.0, 0.0 };
+    MockWeatherApi mock(latency);
+    if (!mock.start()) {
+        std::fprintf(stderr, "Could not start the mock API\n");
+        return 1;
+    }
+    apiClientPool.setHost(mock.host());
+
+    cities.clear();
+    for (size_t i = 0; i < listed_cities; i++) {
+        cities.add(City("City " + std::to_string(i), -179.0 + (i / 160) * 0.05, -80.0 + (i % 160)));
+    }
+
+    // Headless ImGui: a display size and a built font atlas are all NewFrame needs without a backend
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1280.0f, 720.0f);
+    io.IniFilename = NULL;
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    std::shared_ptr<CancellationToken> token = std::make_shared<CancellationToken>();
+    FrameTimes blocking = runFrames([&token](int i) {
+        double lon = 0.0, lat = 0.0;
+        if (validateCity(lookupName("Blocking", i), lon, lat, token) == LookupOutcome::Found) {
+            cities.add(City(lookupName("Blocking", i), lon, lat));
+        }
+        return true;
+        });
+
+    GeocodeJob job;
+    FrameTimes byName = runFrames([&job](int i) {
+        if (!job) {
+            job = startCityLookup(lookupName("Async", i));
+        }
+        if (!job->ready()) {
+            return false;
+        }
+        addNewPlace(job->result());
+        job.reset();
+        return true;
+        });
+
+    FrameTimes reverse = runFrames([&job](int i) {
+        if (!job) {
+            job = startReverseLookup(-60.0 + i * 10.0, -170.0 + i * 30.0);
+        }
+        if (!job->ready()) {
+            return false;
+        }
+        if (!job->failed() && job->result().found) {
+            cities.add(City(job->result().name, job->result().lon, job->result().lat));
+        }
+        job.reset();
+        return true;
+        });
+
+    std::printf("%d lookups each, %d ms mock latency, %zu cities listed, frames paced to 60 Hz\n\n", lookups, latencyMs, listed_cities);
+    std::printf("%-36s %7s %8s %8s %9s %9s %7s\n", "lookup", "frames", "p50 ms", "p99 ms", "max ms", "max gap", "missed");
+    report("Add Place on the UI thread (before)", blocking);
+    report("Add Place, startCityLookup", byName);
+    report("Add Random City, startReverseLookup", reverse);
+    std::printf("\nLookups took %.2f s blocking, %.2f s and %.2f s as jobs; %zu cities listed at the end\n",
+        blocking.lookupSeconds, byName.lookupSeconds, reverse.lookupSeconds, cities.size());
+    ImGui::DestroyContext();
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "MockWeatherApi.h"
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <sstream>
+
+namespace {
+
+const size_t mock_server_threads = 64; // Enough that the mock never queues the app's requests
+
+// Function to Derive a Stable City Id from the Coordinates of a Request
+int mockCityId(const std::string& lat, const std::string& lon) {
+    return 1 + static_cast<int>(std::hash<std::string>()(lat + "," + lon) % 9000000);
+}
+
+}
+
+// Function to Format One Current-Weather Body in the shape OpenWeatherMap sends
+std::string mockWeatherBody(int id, double lat, double lon) {
+    char body[640];
+    std::snprintf(body, sizeof(body),
+        "{\"coord\":{\"lon\":%.4f,\"lat\":%.4f},\"weather\":[{\"id\":803,\"main\":\"Clouds\",\"description\":\"broken clouds\","
+        "\"icon\":\"04d\"}],\"base\":\"stations\",\"main\":{\"temp\":%.2f,\"feels_like\":285.61,\"temp_min\":285.1,"
+        "\"temp_max\":287.9,\"pressure\":1016,\"humidity\":%d},\"visibility\":10000,\"wind\":{\"speed\":4.12,\"deg\":230},"
+        "\"clouds\":{\"all\":75},\"dt\":1729238400,\"sys\":{\"type\":2,\"id\":2041230,\"country\":\"XX\",\"sunrise\":1729230000,"
+        "\"sunset\":1729269000},\"timezone\":0,\"id\":%d,\"name\":\"Mock %d\",\"cod\":200}",
+        lon, lat, 280.0 + (id % 300) / 10.0, 40 + id % 50, id, id);
+    return body;
+}
+
+MockWeatherApi::MockWeatherApi(const MockLatency& latency) : latency(latency), port(0), served(0), rng(42) {
+    server.new_task_queue = []() { return new httplib::ThreadPool(mock_server_threads); };
+    server.set_tcp_nodelay(true); // Otherwise Nagle holds each body back for the client's delayed ACK (~40 ms)
+    server.Get("/data/2.5/weather", [this](const httplib::Request& request, httplib::Response& response) { answer(request, response); });
+    server.Get("/data/2.5/group", [this](const httplib::Request& request, httplib::Response& response) { answer(request, response); });
+    server.Get("/geo/1.0/direct", [this](const httplib::Request& request, httplib::Response& response) { answer(request, response); });
+    server.Get("/geo/1.0/reverse", [this](const httplib::Request& request, httplib::Response& response) { answer(request, response); });
+}
+
+MockWeatherApi::~MockWeatherApi() {
+    stop();
+}
+
+bool MockWeatherApi::start() {
+    port = server.bind_to_any_port("127.0.0.1");
+    if (port <= 0) {
+        return false;
+    }
+    listener = std::thread([this]() { server.listen_after_bind(); });
+    server.wait_until_ready();
+    return true;
+}
+
+void MockWeatherApi::stop() {
+    if (listener.joinable()) {
+        server.stop();
+        listener.join();
+    }
+}
+
+std::string MockWeatherApi::host() const {
+    return "http://127.0.0.1:" + std::to_string(port);
+}
+
+std::chrono::milliseconds MockWeatherApi::pickDelay(bool& fail) {
+    std::lock_guard<std::mutex> lock(rngMutex);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    fail = unit(rng) < latency.failureFraction;
+    return !fail && unit(rng) < latency.slowFraction ? latency.slow : latency.typical;
+}
+
+// Function to Answer One Request after the simulated network and server time
+void MockWeatherApi::answer(const httplib::Request& request, httplib::Response& response) {
+    served++;
+    bool fail = false;
+    std::this_thread::sleep_for(pickDelay(fail));
+    if (fail) {
+        response.status = 503;
+        response.set_content("{\"cod\":503,\"message\":\"service unavailable\"}", "application/json");
+        return;
+    }
+
+    if (request.path == "/data/2.5/weather") {
+        std::string lat = request.get_param_value("lat");
+        std::string lon = request.get_param_value("lon");
+        response.set_content(mockWeatherBody(mockCityId(lat, lon), std::atof(lat.c_str()), std::atof(lon.c_str())), "application/json");
+        return;
+    }
+    if (request.path == "/geo/1.0/direct" || request.path == "/geo/1.0/reverse") {
+        // Every name is a known place, at a location derived from it; every coordinate has a place nearby
+        std::string name = request.get_param_value("q");
+        double lat = std::atof(request.get_param_value("lat").c_str());
+        double lon = std::atof(request.get_param_value("lon").c_str());
+        if (request.path == "/geo/1.0/direct") {
+            int id = mockCityId(name, "");
+            lat = -80.0 + (id % 16000) / 100.0;
+            lon = -179.0 + (id / 16000 % 358);
+        }
+        else {
+            name = "Mock " + std::to_string(mockCityId(request.get_param_value("lat"), request.get_param_value("lon")));
+        }
+        char place[256];
+        std::snprintf(place, sizeof(place), "[{\"name\":\"%s\",\"lat\":%.4f,\"lon\":%.4f,\"country\":\"XX\"}]",
+            name.c_str(), lat, lon);
+        response.set_content(place, "application/json");
+        return;
+    }
+    std::string list;
+    std::istringstream ids(request.get_param_value("id"));
+    std::string id;
+    size_t count = 0;
+    while (std::getline(ids, id, ',')) {
+        list += (count++ == 0 ? "" : ",") + mockWeatherBody(std::atoi(id.c_str()), 0.0, 0.0);
+    }
+    response.set_content("{\"cnt\":" + std::to_string(count) + ",\"list\":[" + list + "]}", "application/json");
+}
@@ -0,0 +1,57 @@
+#ifndef MOCKWEATHERAPI_H
+#define MOCKWEATHERAPI_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <httplib.h>
+
+// Mock Latency: How long the mock takes to answer. Most requests take `typical`; a `slowFraction` of
+// them take `slow` instead, and a `failureFraction` are answered with 503 after the typical latency.
+struct MockLatency {
+    std::chrono::milliseconds typical;
+    std::chrono::milliseconds slow;
+    double slowFraction;
+    double failureFraction;
+};
+
+// Function to Format One Current-Weather Body for city `id`, in the shape OpenWeatherMap sends
+std::string mockWeatherBody(int id, double lat, double lon);
+
+// Mock Weather API: A local stand-in for the OpenWeatherMap endpoints the app calls, for the benchmarks.
+// It answers /data/2.5/weather by coordinates and /data/2.5/group by ids with OWM-shaped bodies; the
+// city id of a coordinate is stable, so a second refresh can go through the group endpoint. The
+// geocoding endpoints (/geo/1.0/direct and /reverse) find a place for every name and coordinate.
+class MockWeatherApi {
+public:
+    explicit MockWeatherApi(const MockLatency& latency);
+    ~MockWeatherApi();
+
+    MockWeatherApi(const MockWeatherApi&) = delete;
+    MockWeatherApi& operator=(const MockWeatherApi&) = delete;
+
+    // Listen on a free port of 127.0.0.1; false if no port could be bound
+    bool start();
+    void stop();
+
+    // Base URL to give HttpClientPool::setHost
+    std::string host() const;
+    size_t requests() const { return served; }
+
+private:
+    void answer(const httplib::Request& request, httplib::Response& response);
+    std::chrono::milliseconds pickDelay(bool& fail);
+
+    MockLatency latency;
+    httplib::Server server;
+    std::thread listener;
+    int port;
+    std::atomic<size_t> served;
+    std::mutex rngMutex;
+    std::mt19937 rng;
+};
+
+#endif // MOCKWEATHERAPI_H
@@ -0,0 +1,104 @@
+// My List Bulk Benchmark: Moves every city into My List and back the way main.cpp's buttons do, timing
+// each step's lookups by name through the registry's name index (CityRegistry::find) and, as before
+// the index, through a linear scan of the registry. The scan is quadratic, so it runs on at most
+// linear_scan_cities (50,000 cities would take about a minute).
+// Usage: my_list_bulk_bench [cities, default 50000]
+#include "CityRegistry.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <set>
+
+namespace {
+
+const size_t linear_scan_cities = 5000;
+
+typedef City* (*FindByName)(CityRegistry& cities, const std::string& name);
+
+City* findIndexed(CityRegistry& cities, const std::string& name) {
+    return cities.find(name);
+}
+
+// The search every bulk operation did per city before the name index
+City* findLinear(CityRegistry& cities, const std::string& name) {
+    for (auto& city : cities) {
+        if (city.name == name) {
+            return &city;
+        }
+    }
+    return nullptr;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point started) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+}
+
+void fillCities(CityRegistry& cities, size_t count) {
+    cities.clear();
+    for (size_t i = 0; i < count; i++) {
+        cities.add(City("City " + std::to_string(i), -179.0 + (i / 160) * 0.05, -80.0 + (i % 160), true));
+    }
+}
+
+// Function to Run "Add to My List", the My List part of "See Weather" and "Remove from My List" for every city
+void run(const char* name, size_t count, FindByName find) {
+    CityRegistry cities;
+    fillCities(cities, count);
+    std::set<std::string> favorites;
+    std::map<std::string, bool> selectedFavorites;
+
+    // "Add to My List": every city is selected and moves over (cities stay in the registry)
+    auto started = std::chrono::steady_clock::now();
+    std::vector<const City*> added;
+    for (auto& city : cities) {
+        if (city.selected && favorites.find(city.name) == favorites.end()) {
+            favorites.insert(city.name);
+            selectedFavorites[city.name] = true;
+            added.push_back(&city);
+        }
+    }
+    double addMs = millisecondsSince(started);
+
+    // "See Weather": each selected favorite is looked up to become a fetch target
+    started = std::chrono::steady_clock::now();
+    std::vector<City*> targets;
+    for (auto& favorite : favorites) {
+        if (selectedFavorites[favorite]) {
+            City* city = find(cities, favorite);
+            if (city && !city->geocodePending) {
+                targets.push_back(city);
+            }
+        }
+    }
+    double targetsMs = millisecondsSince(started);
+
+    // "Remove from My List": each name goes back to the main list unless it is already there
+    started = std::chrono::steady_clock::now();
+    for (auto& favorite : std::vector<std::string>(favorites.begin(), favorites.end())) {
+        favorites.erase(favorite);
+        if (!find(cities, favorite)) {
+            cities.add(City(favorite, 0.0, 0.0));
+        }
+        selectedFavorites.erase(favorite);
+    }
+    double removeMs = millisecondsSince(started);
+
+    std::printf("%-14s %8zu %12.1f %14.1f %12.1f %10.1f%s\n", name, count, addMs, targetsMs, removeMs, addMs + targetsMs + removeMs,
+        added.size() == count && targets.size() == count && cities.size() == count ? "" : "  (wrong result)");
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 50000;
+    std::printf("Every city moved into My List and back, ms\n\n");
+    std::printf("%-14s %8s %12s %14s %12s %10s\n", "lookup", "cities", "add to list", "see weather", "remove", "total");
+    run("name index", count, findIndexed);
+    if (count > linear_scan_cities) {
+        run("name index", linear_scan_cities, findIndexed);
+    }
+    run("linear scan", std::min(count, linear_scan_cities), findLinear);
+    return 0;
+}
@@ -0,0 +1,121 @@
+// Popup Frame Benchmark: One frame of the "Weather Data" popup body for 5,000 cities in a headless ImGui
+// context (no window or renderer backend), built from the JSON tree of each response as the popup did
+// before WeatherSnapshot, and from the snapshot fields as it does now. Icons are left out; they need a GL texture.
+// Usage: popup_frame_bench [cities, default 5000]
+#include "imgui.h"
+#include "WeatherSnapshot.h"
+#include "MockWeatherApi.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+
+namespace {
+
+const int measured_frames = 180;
+
+struct JsonCity {
+    std::string name;
+    nlohmann::json weatherData;
+};
+
+struct SnapshotCity {
+    std::string name;
+    WeatherSnapshot weatherData;
+};
+
+// The formatter the popup called twice per city before sunrise and sunset were formatted at parse time
+std::string unixToHHMM(int unixTime) {
+    std::time_t t = unixTime;
+    std::tm* tm = std::localtime(&t);
+    char buffer[6];
+    std::strftime(buffer, sizeof(buffer), "%H:%M", tm);
+    return std::string(buffer);
+}
+
+void drawJsonPopup(const std::vector<JsonCity>& cities) {
+    for (const auto& city : cities) {
+        if (!city.weatherData.is_null()) {
+            ImGui::Text("%s:", city.name.c_str());
+            ImGui::Text("Weather: %s", city.weatherData["weather"][0]["description"].get<std::string>().c_str());
+            ImGui::Text("Temperature: %.2f°C", city.weatherData["main"]["temp"].get<double>() - 273.15);
+            ImGui::Text("Humidity: %d%%", city.weatherData["main"]["humidity"].get<int>());
+            ImGui::Text("Wind Speed: %.2f m/s", city.weatherData["wind"]["speed"].get<double>());
+            ImGui::Text("Sunrise: %s", unixToHHMM(city.weatherData["sys"]["sunrise"].get<int>()).c_str());
+            ImGui::Text("Sunset: %s", unixToHHMM(city.weatherData["sys"]["sunset"].get<int>()).c_str());
+            ImGui::Separator();
+        }
+    }
+}
+
+void drawSnapshotPopup(const std::vector<SnapshotCity>& cities) {
+    for (const auto& city : cities) {
+        if (city.weatherData.valid) {
+            ImGui::Text("%s:", city.name.c_str());
+            const WeatherSnapshot& weather = city.weatherData;
+            ImGui::Text("Weather: %s", weather.description);
+            ImGui::Text("Temperature: %.2f°C", weather.temperature - 273.15);
+            ImGui::Text("Humidity: %d%%", weather.humidity);
+            ImGui::Text("Wind Speed: %.2f m/s", weather.windSpeed);
+            ImGui::Text("Sunrise: %s", weather.sunriseText);
+            ImGui::Text("Sunset: %s", weather.sunsetText);
+            ImGui::Separator();
+        }
+    }
+}
+
+// Function to Time Whole Frames (NewFrame to Render) with the popup open; returns the median in ms
+double medianFrameMs(const std::function<void()>& drawBody) {
+    std::vector<double> frames;
+    for (int frame = 0; frame < measured_frames + 1; frame++) {
+        auto started = std::chrono::steady_clock::now();
+        ImGui::GetIO().DeltaTime = 1.0f / 60.0f;
+        ImGui::NewFrame();
+        if (frame == 0) {
+            ImGui::OpenPopup("Weather Data");
+        }
+        if (ImGui::BeginPopupModal("Weather Data", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+            drawBody();
+            ImGui::EndPopup();
+        }
+        ImGui::Render();
+        if (frame > 0) { // The first frame opens the popup and sizes it
+            frames.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count());
+        }
+    }
+    std::nth_element(frames.begin(), frames.begin() + frames.size() / 2, frames.end());
+    return frames[frames.size() / 2];
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 5000;
+    std::vector<JsonCity> jsonCities;
+    std::vector<SnapshotCity> snapshotCities;
+    for (size_t i = 0; i < count; i++) {
+        std::string body = mockWeatherBody(static_cast<int>(i + 1), -80.0 + (i % 160), -179.0 + (i / 160) * 0.05);
+        JsonCity jsonCity = { "City " + std::to_string(i), nlohmann::json::parse(body) };
+        jsonCities.push_back(jsonCity);
+        SnapshotCity snapshotCity = { jsonCity.name, WeatherSnapshot() };
+        WeatherSnapshot::parse(body, snapshotCity.weatherData);
+        snapshotCities.push_back(snapshotCity);
+    }
+
+    // Headless ImGui: a display size and a built font atlas are all NewFrame needs without a backend
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1280.0f, 720.0f);
+    io.IniFilename = NULL;
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    std::printf("Weather popup, %zu cities, median of %d frames\n\n", count, measured_frames);
+    std::printf("JSON tree (before)        %8.2f ms\n", medianFrameMs([&jsonCities]() { drawJsonPopup(jsonCities); }));
+    std::printf("WeatherSnapshot (after)   %8.2f ms\n", medianFrameMs([&snapshotCities]() { drawSnapshotPopup(snapshotCities); }));
+    ImGui::DestroyContext();
+    return 0;
+}
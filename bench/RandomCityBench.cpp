@@ -0,0 +1,66 @@
+// Random City Benchmark: "Add Random City" 10,000 times with the offline gazetteer, the way the button
+// does it (up to 32 draws until a place that is not listed yet), timing each click.
+// Usage: random_city_bench [gazetteer.bin]  (without one, a synthetic 1,000,000-place index is built)
+#include "MusaWeatherApp.h"
+#include "SyntheticGazetteer.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const size_t synthetic_places = 1000000;
+const size_t random_cities = 10000;
+
+double percentile(std::vector<double>& values, double p) {
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(p / 100.0 * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "random_city_bench_gazetteer.bin";
+    if (argc <= 1 && !Gazetteer::write(path, syntheticPlaces(synthetic_places, 5))) {
+        std::fprintf(stderr, "Could not write %s\n", path.c_str());
+        return 1;
+    }
+    if (!gazetteer.open(path)) {
+        std::fprintf(stderr, "Could not open %s\n", path.c_str());
+        return 1;
+    }
+
+    cities.clear();
+    std::mt19937 rng(3);
+    std::vector<double> micros;
+    size_t draws = 0;
+    size_t duplicates = 0;
+    auto started = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < random_cities; i++) {
+        auto clicked = std::chrono::steady_clock::now();
+        GeocodeResult place = { false, "", 0.0, 0.0 };
+        bool listed = true;
+        for (int attempt = 0; attempt < 32 && randomGazetteerPlace(rng, place); attempt++) {
+            draws++;
+            listed = cities.find(place.name) != nullptr;
+            if (!listed) {
+                break;
+            }
+        }
+        if (listed) {
+            duplicates++; // 32 draws found nothing new; the button would add nothing
+        }
+        else {
+            cities.add({ place.name, place.lon, place.lat, false });
+        }
+        micros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - clicked).count());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::printf("%zu places; %zu clicks added %zu unique cities in %.1f ms (%zu draws, %zu clicks found nothing new)\n",
+        gazetteer.placeCount(), random_cities, cities.size(), seconds * 1000.0, draws, duplicates);
+    std::printf("per click: p50 %.1f us, p99 %.1f us, max %.1f us\n", percentile(micros, 50.0), percentile(micros, 99.0),
+        *std::max_element(micros.begin(), micros.end()));
+    cities.clear();
+    return 0;
+}
@@ -0,0 +1,120 @@
+// Request Latency Benchmark: End-to-end latency of apiGet against a local mock with a heavy tail and
+// occasional 503s, once with a naive policy (one attempt, no hedge) and once with default_request_policy.
+// Each request runs on fetchPool the way a refresh does; its full time, retries included, goes into a histogram.
+// Usage: request_latency_bench [requests per policy, default 2000]
+#include "MusaWeatherApp.h"
+#include "MockWeatherApi.h"
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+struct PolicyResult {
+    LatencyHistogram latency;
+    std::atomic<size_t> failed;
+    double seconds;
+};
+
+// Function to Send `count` Requests through fetchPool with `policy` and wait for all of them
+void runPolicy(const RequestPolicy& policy, size_t count, int run, PolicyResult& result) {
+    apiLatency.reset(); // Each policy learns its own hedge delay
+    result.failed = 0;
+    std::mutex mutex;
+    std::condition_variable allDone;
+    size_t finished = 0;
+    auto started = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) {
+        char path[160];
+        std::snprintf(path, sizeof(path), "/data/2.5/weather?lat=%.3f&lon=%.3f&appid=%s",
+            -80.0 + static_cast<double>(i % 160) + 0.013 * run, -179.0 + static_cast<double>(i / 160) * 0.05, api_key.c_str());
+        std::string url = path;
+        fetchPool.submit([url, &policy, &result, &mutex, &allDone, &finished, count]() {
+            auto sent = std::chrono::steady_clock::now();
+            httplib::Result res = apiGet(url, policy, nullptr);
+            result.latency.record(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - sent));
+            if (!res || res->status != 200) {
+                result.failed++;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (++finished == count) {
+                allDone.notify_all();
+            }
+            });
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [&finished, count]() { return finished == count; });
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
+
+void report(const char* name, const PolicyResult& result, size_t count) {
+    std::printf("%-8s %7lld %7lld %7lld %8lld %8zu %9.2f\n", name,
+        static_cast<long long>(result.latency.percentile(50.0).count()), static_cast<long long>(result.latency.percentile(90.0).count()),
+        static_cast<long long>(result.latency.percentile(99.0).count()), static_cast<long long>(result.latency.percentile(99.9).count()),
+        result.failed.load(), count / result.seconds);
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 2000;
+    // 3% of answers take 1.5 s instead of 20 ms, and 3% are 503s
+    MockLatency latency = { std::chrono::milliseconds(20), std::chrono::milliseconds(1500), 0.03, 0.03 };
+    MockWeatherApi mock(latency);
+    if (!mock.start()) {
+        std::fprintf(stderr, "Could not start the mock API\n");
+        return 1;
+    }
+    api_key = "benchmark";
+    apiClientPool.setHost(mock.host());
+    apiRateLimiter.setRate(1e9); // The mock has no quota; the concurrency cap still applies
+
+    // Before the request policy: a single attempt with the old 30 s read timeout
+    const RequestPolicy naive_policy = {
+        std::chrono::milliseconds(30000), 0, std::chrono::milliseconds(0), std::chrono::milliseconds(0), false
+    };
+    std::printf("%zu requests per policy, mock 20 ms typical, 3%% at 1500 ms, 3%% 503\n\n", count);
+    std::printf("%-8s %7s %7s %7s %8s %8s %9s\n", "policy", "p50 ms", "p90 ms", "p99 ms", "p99.9 ms", "failed", "req/s");
+    PolicyResult naive;
+    runPolicy(naive_policy, count, 0, naive);
+    report("naive", naive, count);
+    PolicyResult tuned;
+    runPolicy(default_request_policy, count, 1, tuned);
+    report("default", tuned, count);
+    std::printf("\ndefault policy: %zu retries, %zu hedges sent, %zu won, %zu stopped, %zu deadlines exceeded\n",
+        apiRequestStats.retries.load(), apiRequestStats.hedgesSent.load(), apiRequestStats.hedgesWon.load(),
+        apiRequestStats.hedgesStopped.load(), apiRequestStats.deadlinesExceeded.load());
+
+    // A losing hedge must be closed once its primary answers rather than hold a hedgePool worker and a
+    // rate-limiter slot until its own deadline; every hedge still out then shows up as stopped.
+    // Time until hedgePool is idle again after the last primary tells whether any were left running.
+    size_t lost = apiRequestStats.hedgesSent.load() - apiRequestStats.hedgesWon.load();
+    auto drainStarted = std::chrono::steady_clock::now();
+    std::mutex mutex;
+    std::condition_variable drained;
+    size_t idleWorkers = 0;
+    for (size_t i = 0; i < hedgePool.maxWorkers(); i++) {
+        hedgePool.submit([&mutex, &drained, &idleWorkers]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            idleWorkers++;
+            drained.notify_all();
+            drained.wait(lock, [&idleWorkers]() { return idleWorkers == hedgePool.maxWorkers(); });
+            });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [&idleWorkers]() { return idleWorkers == hedgePool.maxWorkers(); });
+    }
+    long long drainMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - drainStarted).count();
+    std::printf("hedgePool idle %lld ms after the last request\n", drainMs);
+    mock.stop();
+    if (lost > 0 && apiRequestStats.hedgesStopped.load() == 0) {
+        std::fprintf(stderr, "FAIL: %zu hedges lost and none was stopped by its primary\n", lost);
+        return 1;
+    }
+    if (drainMs >= latency.slow.count()) {
+        std::fprintf(stderr, "FAIL: losing hedges kept hedgePool busy for %lld ms after the last request\n", drainMs);
+        return 1;
+    }
+    return 0;
+}
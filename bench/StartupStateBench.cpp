@@ -0,0 +1,199 @@
+// Startup State Benchmark: Time to first frame with 100,000 listed cities, 10,000 of them favorites,
+// without a window: loadAppState from the app-state snapshot, then the first frame of the city and
+// My List columns drawn in a headless ImGui context as main.cpp draws them (only the rows in view),
+// then a later frame, and for comparison a frame that submits every row, as main.cpp did before. The font atlas is built
+// before the clock starts; with a window, creating its texture and the shaders comes on top (see
+// MusaWeatherApp --startup-benchmark). Writes favorites.txt and app_state.bin in the current
+// directory, so it refuses to run where they already exist.
+// Usage: startup_state_bench [cities, default 100000]
+#include "MusaWeatherApp.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace {
+
+const int measured_runs = 5;
+const size_t favorite_every = 10; // One city in ten is a favorite
+const double first_frame_budget_ms = 100.0;
+const std::chrono::milliseconds settle_time(500); // For restoreWeather's decode on the lookup pool, so runs do not overlap
+
+bool exists(const std::string& path) {
+    return std::ifstream(path).is_open();
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point started) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+}
+
+// Function to Write the Files a Session with `count` Cities Leaves Behind: favorites.txt and a snapshot
+// with every city and the weather the cache holds
+void writeSession(size_t count) {
+    cities.clear();
+    std::set<std::string> favorites;
+    std::map<std::string, bool> selectedFavorites;
+    for (size_t i = 0; i < count; i++) {
+        City city("City " + std::to_string(i), -179.0 + (i / 160) * 0.05, -80.0 + (i % 160), i % 3 == 0);
+        city.owmId = static_cast<int>(i + 1);
+        cities.add(city);
+        if (i % favorite_every == 0) {
+            favorites.insert(city.name);
+            selectedFavorites[city.name] = i % 20 == 0;
+        }
+        WeatherSnapshot data = WeatherSnapshot();
+        data.valid = true;
+        data.cityId = city.owmId;
+        data.temperature = 280.0 + (i % 300) / 10.0;
+        weatherCache.put(locationKey(city.lat, city.lon), data);
+    }
+    saveMyCityList(cities, favorites);
+    saveAppState(favorites, selectedFavorites, true);
+}
+
+void drawRow(const char* name, bool& selected) {
+    ImGui::Checkbox(name, &selected);
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(0.4f, 0.7f, 1.0f, 1.0f), selected ? "Selected" : " ");
+}
+
+// Function to Draw the List Columns with every row submitted, as main.cpp did before it clipped them
+void drawEveryRow(const std::set<std::string>& favorites, std::map<std::string, bool>& selectedFavorites) {
+    ImGui::Begin("Musa's Weather Channel");
+    ImGui::Columns(3, NULL, false);
+    ImGui::BeginChild("City Selection", ImVec2(0, 500.0f), true);
+    for (auto& city : cities) {
+        if (favorites.find(city.name) == favorites.end()) {
+            drawRow(city.name.c_str(), city.selected);
+        }
+    }
+    ImGui::EndChild();
+    ImGui::NextColumn();
+    ImGui::BeginChild("My List", ImVec2(0, 500.0f), true);
+    for (const auto& name : favorites) {
+        drawRow(name.c_str(), selectedFavorites[name]);
+    }
+    ImGui::EndChild();
+    ImGui::Columns(1);
+    ImGui::End();
+}
+
+// Function to Draw the List Columns the way main.cpp does: only the rows in view, from a list of the
+// shown cities rebuilt when the registry changes (favorites do not change here)
+void drawClipped(const std::set<std::string>& favorites, std::map<std::string, bool>& selectedFavorites,
+    std::vector<City*>& shownCities, uint64_t& shownForCities) {
+    ImGui::Begin("Musa's Weather Channel");
+    ImGui::Columns(3, NULL, false);
+    ImGui::BeginChild("City Selection", ImVec2(0, 500.0f), true);
+    if (shownForCities != cities.revision()) {
+        shownCities.clear();
+        for (auto& city : cities) {
+            if (favorites.find(city.name) == favorites.end()) {
+                shownCities.push_back(&city);
+            }
+        }
+        shownForCities = cities.revision();
+    }
+    ImGuiListClipper cityClipper;
+    cityClipper.Begin(static_cast<int>(shownCities.size()));
+    while (cityClipper.Step()) {
+        for (int row = cityClipper.DisplayStart; row < cityClipper.DisplayEnd; row++) {
+            drawRow(shownCities[row]->name.c_str(), shownCities[row]->selected);
+        }
+    }
+    ImGui::EndChild();
+    ImGui::NextColumn();
+    ImGui::BeginChild("My List", ImVec2(0, 500.0f), true);
+    ImGuiListClipper favoriteClipper;
+    favoriteClipper.Begin(static_cast<int>(favorites.size()));
+    std::set<std::string>::const_iterator it = favorites.begin();
+    int favoriteRow = 0;
+    while (favoriteClipper.Step()) {
+        for (; favoriteRow < favoriteClipper.DisplayStart; favoriteRow++) {
+            ++it;
+        }
+        for (; favoriteRow < favoriteClipper.DisplayEnd; favoriteRow++, ++it) {
+            drawRow(it->c_str(), selectedFavorites[*it]);
+        }
+    }
+    ImGui::EndChild();
+    ImGui::Columns(1);
+    ImGui::End();
+}
+
+// Function to Time One Frame (NewFrame to Render) drawing the lists with `draw`
+double frameMs(const std::function<void()>& draw) {
+    auto started = std::chrono::steady_clock::now();
+    ImGui::GetIO().DeltaTime = 1.0f / 60.0f;
+    ImGui::NewFrame();
+    cities.collectWeather();
+    draw();
+    ImGui::Render();
+    return millisecondsSince(started);
+}
+
+double median(std::vector<double> values) {
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 100000;
+    if (exists(favorites_file) || exists(app_state_file)) {
+        std::fprintf(stderr, "%s or %s exists here; run this in an empty directory\n", favorites_file.c_str(), app_state_file.c_str());
+        return 1;
+    }
+    writeSession(count);
+
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1280.0f, 720.0f);
+    io.IniFilename = NULL;
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    std::vector<double> loadMs, firstFrameMs, totalMs, laterFrameMs, everyRowMs;
+    size_t listed = 0;
+    size_t favoriteCount = 0;
+    for (int run = 0; run < measured_runs; run++) {
+        cities.clear();
+        std::set<std::string> favorites;
+        std::map<std::string, bool> selectedFavorites;
+        auto started = std::chrono::steady_clock::now();
+        std::map<std::string, GeocodeJob> lookups = loadAppState(favorites, selectedFavorites);
+        double load = millisecondsSince(started);
+        std::vector<City*> shownCities;
+        uint64_t shownForCities = 0;
+        double firstFrame = frameMs([&]() { drawClipped(favorites, selectedFavorites, shownCities, shownForCities); });
+        loadMs.push_back(load);
+        firstFrameMs.push_back(firstFrame);
+        totalMs.push_back(load + firstFrame);
+        std::this_thread::sleep_for(settle_time);
+        laterFrameMs.push_back(frameMs([&]() { drawClipped(favorites, selectedFavorites, shownCities, shownForCities); }));
+        everyRowMs.push_back(frameMs([&]() { drawEveryRow(favorites, selectedFavorites); }));
+        listed = cities.size();
+        favoriteCount = favorites.size();
+    }
+
+    std::printf("%zu cities, %zu favorites restored from %s; median and max of %d runs, ms\n\n", listed, favoriteCount,
+        app_state_file.c_str(), measured_runs);
+    std::printf("%-34s %9s %9s\n", "", "median", "max");
+    std::printf("%-34s %9.1f %9.1f\n", "load app state", median(loadMs), *std::max_element(loadMs.begin(), loadMs.end()));
+    std::printf("%-34s %9.1f %9.1f\n", "first frame", median(firstFrameMs), *std::max_element(firstFrameMs.begin(), firstFrameMs.end()));
+    std::printf("%-34s %9.1f %9.1f  (budget %.0f ms)\n", "time to first frame", median(totalMs),
+        *std::max_element(totalMs.begin(), totalMs.end()), first_frame_budget_ms);
+    std::printf("%-34s %9.1f %9.1f\n", "a later frame", median(laterFrameMs), *std::max_element(laterFrameMs.begin(), laterFrameMs.end()));
+    std::printf("%-34s %9.1f %9.1f\n", "a frame drawing every row (before)", median(everyRowMs),
+        *std::max_element(everyRowMs.begin(), everyRowMs.end()));
+    ImGui::DestroyContext();
+    std::remove(favorites_file.c_str());
+    std::remove(favorites_journal_file.c_str());
+    std::remove(app_state_file.c_str());
+    return median(totalMs) <= first_frame_budget_ms ? 0 : 2;
+}
@@ -0,0 +1,54 @@
+#include "SyntheticGazetteer.h"
+#include <cmath>
+#include <random>
+
+namespace {
+
+const char* const name_syllables[] = {
+    "ka", "ber", "lin", "ton", "mar", "sa", "do", "ri", "vel", "an", "os", "te", "gra", "no", "bu", "chel",
+    "port", "ville", "ham", "ste", "ro", "mi", "la", "zen", "dor", "que", "fa", "li", "burg", "ne", "wa", "ko",
+    "shi", "ta", "mo", "ra", "el", "in", "go", "ba", "pe", "tra", "vi", "sto", "ny", "ar", "cas", "le"
+};
+const char* const second_words[] = { "City", "Springs", "Heights", "Bay", "Falls", "Hills", "Beach", "Park" };
+const char* const first_words[] = { "New", "San", "Port", "Lake", "Mount", "Saint", "North", "Santa" };
+const char* const countries[] = { "US", "DE", "FR", "BR", "IN", "JP", "NG", "AU", "MX", "RU", "CN", "GB" };
+
+std::string syllableName(std::mt19937& rng) {
+    std::uniform_int_distribution<size_t> syllable(0, sizeof(name_syllables) / sizeof(name_syllables[0]) - 1);
+    int syllables = std::uniform_int_distribution<int>(2, 4)(rng);
+    std::string name;
+    for (int i = 0; i < syllables; i++) {
+        name += name_syllables[syllable(rng)];
+    }
+    name[0] = static_cast<char>(name[0] - 'a' + 'A');
+    return name;
+}
+
+}
+
+std::vector<Gazetteer::Source> syntheticPlaces(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Gazetteer::Source> sources(count);
+    for (size_t i = 0; i < count; i++) {
+        Gazetteer::Source& source = sources[i];
+        source.place.name = syllableName(rng);
+        double kind = unit(rng);
+        if (kind < 0.1) {
+            source.place.name = std::string(first_words[rng() % 8]) + " " + source.place.name;
+        }
+        else if (kind < 0.2) {
+            source.place.name += std::string(" ") + second_words[rng() % 8];
+        }
+        source.place.country = countries[rng() % 12];
+        source.place.lat = std::asin(2.0 * unit(rng) - 1.0) * 180.0 / 3.14159265358979323846;
+        source.place.lon = unit(rng) * 360.0 - 180.0;
+        source.place.population = static_cast<uint32_t>(2.0e7 / std::pow(static_cast<double>(i + 1), 0.9)) + static_cast<uint32_t>(rng() % 1000);
+        source.place.geonameId = static_cast<uint32_t>(i + 1);
+        int alternates = static_cast<int>(rng() % 3);
+        for (int a = 0; a < alternates; a++) {
+            source.alternateNames.push_back(syllableName(rng));
+        }
+    }
+    return sources;
+}
@@ -0,0 +1,13 @@
+#ifndef SYNTHETICGAZETTEER_H
+#define SYNTHETICGAZETTEER_H
+
+#include <cstdint>
+#include <vector>
+#include "Gazetteer.h"
+
+// Function to Make `count` Made-Up Places for Gazetteer::write: syllable names (some with a second
+// word or alternate names, as GeoNames rows have), a Zipf-like population spread and locations uniform
+// over the sphere. The same seed always gives the same places.
+std::vector<Gazetteer::Source> syntheticPlaces(size_t count, uint32_t seed);
+
+#endif // SYNTHETICGAZETTEER_H
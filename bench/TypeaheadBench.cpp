@@ -0,0 +1,109 @@
+// Typeahead Benchmark: Cost of Gazetteer::suggest per keystroke, the call the Add Place popup makes on
+// the UI thread whenever the input changes. Names are typed one character at a time, once as written
+// (prefix matches) and once with a typo, so the keystrokes after the typo take the fuzzy fallback.
+// Usage: typeahead_bench [gazetteer.bin | places]  (without an index, a synthetic one with `places`
+// places is built, 3,000,000 by default: about as many names as the full GeoNames dump)
+#include "Gazetteer.h"
+#include "SyntheticGazetteer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+const size_t synthetic_places = 3000000;
+const size_t typed_names = 2000;
+const size_t suggestion_limit = 8; // max_place_suggestions
+
+struct Timings {
+    std::vector<double> micros;
+    std::vector<double> fuzzyMicros; // The calls that fell back to fuzzy matching
+};
+
+void typeName(const Gazetteer& gazetteer, const std::string& name, Timings& timings) {
+    for (size_t length = 1; length <= name.size(); length++) {
+        std::string typed = name.substr(0, length);
+        bool fuzzy = false;
+        auto started = std::chrono::steady_clock::now();
+        std::vector<Gazetteer::Place> suggestions = gazetteer.suggest(typed, suggestion_limit, &fuzzy);
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started).count();
+        timings.micros.push_back(micros);
+        if (fuzzy) {
+            timings.fuzzyMicros.push_back(micros);
+        }
+    }
+}
+
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(p / 100.0 * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void report(const char* name, std::vector<double>& micros) {
+    double p50 = percentile(micros, 50.0);
+    double p99 = percentile(micros, 99.0);
+    double worst = micros.empty() ? 0.0 : *std::max_element(micros.begin(), micros.end());
+    std::printf("%-12s %9zu %9.1f %9.1f %9.1f\n", name, micros.size(), p50, p99, worst);
+}
+
+// Function to Make a Typo: one edit (insert, delete, substitute or swap) somewhere after the first letter
+std::string withTypo(const std::string& name, std::mt19937& rng) {
+    std::string typo = name;
+    size_t at = 1 + rng() % (name.size() - 1);
+    switch (rng() % 4) {
+    case 0: typo.insert(at, 1, static_cast<char>('a' + rng() % 26)); break;
+    case 1: typo.erase(at, 1); break;
+    case 2: typo[at] = static_cast<char>('a' + rng() % 26); break;
+    default: if (at + 1 < typo.size()) std::swap(typo[at], typo[at + 1]); break;
+    }
+    return typo;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string arg = argc > 1 ? argv[1] : "";
+    bool synthetic = arg.empty() || arg.find_first_not_of("0123456789") == std::string::npos;
+    std::string path = synthetic ? "typeahead_bench_gazetteer.bin" : arg;
+    if (synthetic) {
+        size_t places = arg.empty() ? synthetic_places : static_cast<size_t>(std::atol(arg.c_str()));
+        std::vector<Gazetteer::Source> sources = syntheticPlaces(places, 7);
+        if (!Gazetteer::write(path, sources)) {
+            std::fprintf(stderr, "Could not write %s\n", path.c_str());
+            return 1;
+        }
+    }
+    Gazetteer gazetteer;
+    if (!gazetteer.open(path)) {
+        std::fprintf(stderr, "Could not open %s\n", path.c_str());
+        return 1;
+    }
+
+    // Names to type: sampled by population, as people mostly look up larger places
+    std::mt19937 rng(11);
+    std::vector<std::string> names;
+    for (size_t i = 0; i < typed_names; i++) {
+        Gazetteer::Place place;
+        if (gazetteer.samplePlace(std::uniform_real_distribution<double>(0.0, 1.0)(rng), place) && place.name.size() > 2) {
+            names.push_back(place.name);
+        }
+    }
+    Timings exact;
+    Timings typo;
+    for (const auto& name : names) {
+        typeName(gazetteer, name, exact);
+        typeName(gazetteer, withTypo(name, rng), typo);
+    }
+    std::printf("%zu places, %zu keys, %zu names typed\n\n", gazetteer.placeCount(), gazetteer.keyCount(), names.size());
+    std::printf("%-12s %9s %9s %9s %9s\n", "keystrokes", "calls", "p50 us", "p99 us", "max us");
+    report("as written", exact.micros);
+    report("with typo", typo.micros);
+    report("fuzzy only", typo.fuzzyMicros);
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Weather Parse Benchmark: Throughput (MB/s and responses/s) and heap allocations per response of the
+// ways a current-weather body can become a WeatherSnapshot: a JSON tree read by fromJson (how responses
+// were read before the SAX extractor), WeatherSnapshot::parse, and parseList over /group bodies.
+// Allocations are counted by replacing the global operator new in this program.
+// Usage: weather_parse_bench [responses, default 20000]
+#include "WeatherSnapshot.h"
+#include "MockWeatherApi.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+namespace {
+
+std::atomic<size_t> allocations(0);
+
+const char* const descriptions[] = { "clear sky", "few clouds", "scattered clouds", "broken clouds", "light rain", "mist" };
+
+// Function to Vary the Mock Bodies a Little: descriptions and numbers differ as in a real refresh
+std::string sampleBody(size_t i) {
+    std::string body = mockWeatherBody(static_cast<int>(i + 1), -80.0 + (i % 160), -179.0 + (i / 160) * 0.05);
+    const std::string stock = "broken clouds";
+    body.replace(body.find(stock), stock.size(), descriptions[i % 6]);
+    return body;
+}
+
+void run(const char* name, size_t responses, size_t bytes, const std::function<bool()>& parseAll) {
+    parseAll(); // Warm up: interned texts, thread-local buffers
+    size_t allocationsBefore = allocations;
+    auto started = std::chrono::steady_clock::now();
+    bool ok = parseAll();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    size_t allocated = allocations - allocationsBefore;
+    std::printf("%-26s %9.1f %12.0f %12.2f%s\n", name, bytes / seconds / 1e6, responses / seconds,
+        static_cast<double>(allocated) / responses, ok ? "" : "  (a body did not parse)");
+}
+
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // GCC cannot see that this operator new pairs with the delete below
+#endif
+
+void* operator new(std::size_t size) {
+    allocations++;
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 20000;
+    std::vector<std::string> bodies;
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        bodies.push_back(sampleBody(i));
+        bytes += bodies.back().size();
+    }
+    // /group bodies of up to 20 entries, the size getWeatherDataForGroup asks for
+    std::vector<std::string> groups;
+    size_t groupBytes = 0;
+    for (size_t first = 0; first < count; first += 20) {
+        std::string list;
+        for (size_t i = first; i < first + 20 && i < count; i++) {
+            list += (i == first ? "" : ",") + bodies[i];
+        }
+        groups.push_back("{\"cnt\":20,\"list\":[" + list + "]}");
+        groupBytes += groups.back().size();
+    }
+
+    std::printf("%zu current-weather bodies, %.1f MB\n\n", count, bytes / 1e6);
+    std::printf("%-26s %9s %12s %12s\n", "parser", "MB/s", "responses/s", "allocs/resp");
+    run("JSON tree + fromJson", count, bytes, [&bodies]() {
+        bool ok = true;
+        for (const auto& body : bodies) {
+            ok = WeatherSnapshot::fromJson(nlohmann::json::parse(body)).valid && ok;
+        }
+        return ok;
+        });
+    run("WeatherSnapshot::parse", count, bytes, [&bodies]() {
+        bool ok = true;
+        WeatherSnapshot snapshot;
+        for (const auto& body : bodies) {
+            ok = WeatherSnapshot::parse(body, snapshot) && ok;
+        }
+        return ok;
+        });
+    run("parseList (20 per body)", count, groupBytes, [&groups]() {
+        bool ok = true;
+        std::vector<WeatherSnapshot> snapshots;
+        for (const auto& group : groups) {
+            ok = WeatherSnapshot::parseList(group, snapshots) && ok;
+        }
+        return ok;
+        });
+    return 0;
+}
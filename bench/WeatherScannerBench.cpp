@@ -0,0 +1,97 @@
+// Weather Scanner Benchmark: Throughput (MB/s and responses/s) and heap allocations per response of
+// WeatherScanner::scan on its own and of WeatherSnapshot::parse on top of it, for the kernel this
+// program was compiled with. CMake builds one copy per kernel (scalar, sse2, avx2) so they can be
+// compared on the same machine. Allocations are counted by replacing the global operator new.
+// Usage: weather_scanner_bench [responses, default 20000]
+#include "WeatherScanner.h"
+#include "WeatherSnapshot.h"
+#include "MockWeatherApi.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+namespace {
+
+std::atomic<size_t> allocations(0);
+
+const int measured_passes = 5;
+
+const char* const descriptions[] = { "clear sky", "few clouds", "scattered clouds", "broken clouds", "light rain", "mist" };
+
+// Function to Vary the Mock Bodies a Little: descriptions and numbers differ as in a real refresh
+std::string sampleBody(size_t i) {
+    std::string body = mockWeatherBody(static_cast<int>(i + 1), -80.0 + (i % 160), -179.0 + (i / 160) * 0.05);
+    const std::string stock = "broken clouds";
+    body.replace(body.find(stock), stock.size(), descriptions[i % 6]);
+    return body;
+}
+
+// Function to Report the Fastest of a Few Passes, after a warm-up pass (interned texts, thread-local buffers)
+void run(const char* name, size_t responses, size_t bytes, const std::function<bool()>& parseAll) {
+    parseAll();
+    size_t allocationsBefore = allocations;
+    double best = 0.0;
+    bool ok = true;
+    for (int pass = 0; pass < measured_passes; pass++) {
+        auto started = std::chrono::steady_clock::now();
+        ok = parseAll() && ok;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        best = pass == 0 || seconds < best ? seconds : best;
+    }
+    size_t allocated = allocations - allocationsBefore;
+    std::printf("%-26s %9.1f %12.0f %12.2f%s\n", name, bytes / best / 1e6, responses / best,
+        static_cast<double>(allocated) / (responses * measured_passes), ok ? "" : "  (a body was not read)");
+}
+
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // GCC cannot see that this operator new pairs with the delete below
+#endif
+
+void* operator new(std::size_t size) {
+    allocations++;
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 20000;
+    std::vector<std::string> bodies;
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        bodies.push_back(sampleBody(i));
+        bytes += bodies.back().size();
+    }
+
+    std::printf("%zu current-weather bodies, %.1f MB, %s kernel, best of %d passes\n\n", count, bytes / 1e6,
+        WeatherScanner::kernel(), measured_passes);
+    std::printf("%-26s %9s %12s %12s\n", "parser", "MB/s", "responses/s", "allocs/resp");
+    run("WeatherScanner::scan", count, bytes, [&bodies]() {
+        bool ok = true;
+        WeatherFields fields;
+        for (const auto& body : bodies) {
+            ok = WeatherScanner::scan(body, fields) == WeatherScanner::Parsed && ok;
+        }
+        return ok;
+        });
+    run("WeatherSnapshot::parse", count, bytes, [&bodies]() {
+        bool ok = true;
+        WeatherSnapshot snapshot;
+        for (const auto& body : bodies) {
+            ok = WeatherSnapshot::parse(body, snapshot) && ok;
+        }
+        return ok;
+        });
+    return 0;
+}
@@ -0,0 +1,48 @@
+#ifndef APPSNAPSHOT_H
+#define APPSNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// App Snapshot: The whole application state in one versioned binary file: every place in the city
+// registry, which of them are favorites or selected, and their last-known weather. The file is
+// memory-mapped and checked against a checksum at startup, then copied out with no text parsing
+// (weather bodies stay encoded until someone needs them).
+class AppSnapshot {
+public:
+    static const uint32_t version = 2; // 2: weather bodies are encoded WeatherSnapshots
+
+    enum PlaceFlags : uint8_t {
+        Selected = 1,        // Checked in whichever list shows the place
+        Favorite = 2,
+        GeocodePending = 4   // Location not known yet
+    };
+
+    struct Place {
+        std::string name;
+        double lon;
+        double lat;
+        int32_t owmId;
+        uint8_t flags;
+    };
+
+    struct Weather {
+        uint32_t place;      // Index into places
+        int64_t fetchedAt;   // Unix time the response was received
+        std::string body;    // WeatherSnapshot::encode() of the response
+    };
+
+    AppSnapshot();
+
+    // Map and validate the file; on any mismatch the snapshot is left empty and false is returned
+    bool load(const std::string& path);
+    // Encode the snapshot; write the result with writeFileAtomically
+    std::string serialize() const;
+
+    std::vector<Place> places;
+    std::vector<Weather> weather;
+    uint64_t favoritesHash; // fileFingerprint of favorites.txt when the snapshot was taken
+};
+
+#endif // APPSNAPSHOT_H
@@ -0,0 +1,71 @@
+#ifndef ASYNCJOB_H
+#define ASYNCJOB_H
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include "CancellationToken.h"
+#include "WorkerPool.h"
+
+// Async Job: Handle to work running on a WorkerPool. The frame loop polls ready() instead of
+// blocking, and reads the result on its own thread once the job has finished.
+template <typename T>
+class AsyncJob {
+public:
+    typedef std::function<T(const std::shared_ptr<CancellationToken>&)> Work;
+
+    static std::shared_ptr<AsyncJob> start(WorkerPool& pool, Work work) {
+        std::shared_ptr<AsyncJob> job(new AsyncJob());
+        pool.submit([job, work]() {
+            if (job->token->isCancelled()) {
+                // Never ran: its default result must not pass for an answer
+                job->errorMessage = "Cancelled";
+                job->hasError = true;
+            }
+            else {
+                try {
+                    job->value = work(job->token);
+                }
+                catch (const std::exception& e) {
+                    job->errorMessage = e.what();
+                    job->hasError = true;
+                }
+            }
+            job->finished = true;
+            });
+        return job;
+    }
+
+    // A job that is already finished, for results known without any work (e.g. served from a local index)
+    static std::shared_ptr<AsyncJob> completed(T result) {
+        std::shared_ptr<AsyncJob> job(new AsyncJob());
+        job->value = result;
+        job->finished = true;
+        return job;
+    }
+
+    AsyncJob(const AsyncJob&) = delete;
+    AsyncJob& operator=(const AsyncJob&) = delete;
+
+    bool ready() const { return finished; }
+    bool failed() const { return finished && hasError; }
+    // Only valid once ready()
+    const T& result() const { return value; }
+    const std::string& error() const { return errorMessage; }
+
+    // Stop waiting for the job; a request it has in flight is aborted by a job on `canceller`
+    void cancel(WorkerPool& canceller) { token->cancelInBackground(canceller); }
+
+private:
+    AsyncJob() : token(std::make_shared<CancellationToken>()), value(), hasError(false), finished(false) {}
+
+    std::shared_ptr<CancellationToken> token;
+    T value;
+    std::string errorMessage;
+    bool hasError;
+    std::atomic<bool> finished; // Set last; publishes value and error to the polling thread
+};
+
+#endif // ASYNCJOB_H
@@ -0,0 +1,62 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+class WorkerPool;
+
+// Cancellation Token: Shared flag that work can poll, sleep on, or hook a callback to
+// (e.g. closing a socket that is blocked in connect or read).
+class CancellationToken : public std::enable_shared_from_this<CancellationToken> {
+public:
+    CancellationToken();
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    // Set the flag, wake sleepers and run every registered callback once
+    void cancel();
+    // The two halves of cancel(): setting the flag never blocks, running callbacks may
+    void requestCancel();
+    void runCallbacks();
+    // Set the flag now and run the callbacks as a job on `pool`, for callers that must not block
+    // (the token must be owned by a shared_ptr)
+    void cancelInBackground(WorkerPool& pool);
+    bool isCancelled() const { return cancelled; }
+
+    // Sleep for up to `duration`; returns true if cancelled before or during the wait
+    bool waitFor(std::chrono::milliseconds duration) const;
+
+    // Run `callback` on cancel (right away if already cancelled); the id removes it again
+    size_t onCancel(std::function<void()> callback) const;
+    void removeCallback(size_t id) const;
+
+private:
+    std::atomic<bool> cancelled;
+    mutable std::mutex mutex;
+    mutable std::condition_variable wake;
+    mutable std::map<size_t, std::function<void()>> callbacks;
+    mutable size_t nextId;
+};
+
+// Cancel Registration: Keeps a cancel callback registered for the lifetime of a scope
+class CancelRegistration {
+public:
+    CancelRegistration(const CancellationToken* token, std::function<void()> callback);
+    ~CancelRegistration();
+
+    CancelRegistration(const CancelRegistration&) = delete;
+    CancelRegistration& operator=(const CancelRegistration&) = delete;
+
+private:
+    const CancellationToken* token;
+    size_t id;
+};
+
+#endif // CANCELLATIONTOKEN_H
@@ -0,0 +1,182 @@
+#ifndef CITYREGISTRY_H
+#define CITYREGISTRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CancellationToken.h"
+#include "WeatherSnapshot.h"
+
+// City Handle: A registry slot plus the generation of the city in it. Removing a city bumps the
+// generation, so an old handle never reaches a city that later reuses the slot. {0, 0} names nothing.
+struct CityHandle {
+    uint32_t index;
+    uint32_t generation;
+
+    bool valid() const { return generation != 0; }
+    bool operator==(const CityHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const CityHandle& other) const { return !(*this == other); }
+};
+
+// Struct Definition: Defines a data structure to hold information about a city.
+struct City {
+    std::string name;
+    double lon = 0.0;
+    double lat = 0.0;
+    bool selected = false;
+    WeatherSnapshot weatherData = WeatherSnapshot(); // Parsed when the response arrives; valid == false until then
+    int owmId = 0; // OpenWeatherMap city id, learned from the first weather response (0 = unknown)
+    bool geocodePending = false; // Loaded by name only (old favorites.txt line); lon/lat are not known yet
+    CityHandle handle = CityHandle(); // Set by CityRegistry::add
+
+    City() {}
+    City(const std::string& name, double lon, double lat, bool selected = false)
+        : name(name), lon(lon), lat(lat), selected(selected) {}
+};
+
+// City Registry: Every listed city, in the order added. Cities live in fixed-size chunks that never
+// move, so a City* stays valid until that city is removed, and adding or removing one is O(1) (freed
+// slots are reused; a linked list keeps the display order). Cities belong to the UI thread. Fetch
+// jobs hold handles instead: deliverWeather() parks a result in the city's slot under that slot's own
+// lock, and the UI thread applies parked results with collectWeather() once per frame. A city removed
+// meanwhile simply drops its result, so the list may change while a batch is running. A hash index
+// from name to city keeps lookups by name O(1); names must not be changed after add().
+class CityRegistry {
+public:
+    class Iterator;
+    class ConstIterator;
+
+    CityRegistry();
+    CityRegistry(std::initializer_list<City> initial);
+    ~CityRegistry();
+
+    CityRegistry(const CityRegistry&) = delete;
+    CityRegistry& operator=(const CityRegistry&) = delete;
+
+    // UI thread. add() returns an invalid handle if the registry is full
+    CityHandle add(const City& city);
+    bool remove(CityHandle handle);
+    void clear();
+    // Make room in the name index for `cities` cities, so a bulk load does not rehash it as it grows
+    void reserve(size_t cities) { byName.reserve(cities); }
+    // Null if the handle's city was removed
+    City* get(CityHandle handle);
+    const City* get(CityHandle handle) const;
+    // First city (in display order) with this name; null if none
+    City* find(const std::string& name);
+    const City* find(const std::string& name) const;
+    size_t size() const { return count; }
+    // Changes with every add and remove, so a view of the list can be kept until the list changes
+    uint64_t revision() const { return changes; }
+    bool empty() const { return count == 0; }
+
+    // Any thread: park a weather result for the city, replacing any result parked before; false if the
+    // city was removed or `token` is already cancelled. The result is dropped instead of applied if
+    // `token` is cancelled before the UI thread collects it.
+    bool deliverWeather(CityHandle handle, const WeatherSnapshot& data, const std::shared_ptr<CancellationToken>& token);
+    // UI thread: apply parked results (weather, and the city id it carries); returns how many were applied
+    size_t collectWeather();
+
+    Iterator begin();
+    Iterator end();
+    ConstIterator begin() const;
+    ConstIterator end() const;
+
+private:
+    static const uint32_t none = 0xFFFFFFFF;
+    static const size_t chunk_size = 512;
+    static const size_t max_chunks = 4096; // About two million cities
+
+    struct Slot {
+        City city;
+        uint32_t generation; // Even while free, odd while it holds a city
+        uint32_t prev;       // Neighbours in display order (UI thread only)
+        uint32_t next;
+        uint32_t nextFree;
+        uint32_t prevSameName; // Other cities with the same name, in display order (UI thread only)
+        uint32_t nextSameName;
+        // Mailbox for one delivered result, guarded by `mutex`
+        std::mutex mutex;
+        bool queued;          // On the delivered list, waiting for collectWeather()
+        uint32_t nextDelivered;
+        CityHandle deliveredFor;
+        WeatherSnapshot delivered;
+        std::shared_ptr<CancellationToken> deliveredToken;
+    };
+
+    Slot& slot(uint32_t index) { return chunks[index / chunk_size][index % chunk_size]; }
+    const Slot& slot(uint32_t index) const { return chunks[index / chunk_size][index % chunk_size]; }
+    bool live(CityHandle handle) const;
+    uint32_t findIndex(const std::string& name) const;
+
+    // First and last slot of each name's chain; names repeat (two built-in "Buenos Aires"), so
+    // removing the first city of a name promotes the next one
+    struct NameChain {
+        uint32_t first;
+        uint32_t last;
+    };
+
+    // A chunk pointer is written once, before any handle into the chunk exists, and handles reach
+    // workers through the pool's queue, so workers read these without a lock
+    Slot* chunks[max_chunks];
+    size_t chunkCount;
+    uint32_t slotsUsed; // Slots ever handed out; the ones below this are in use or on the free list
+    uint32_t freeHead;
+    uint32_t head;
+    uint32_t tail;
+    size_t count;
+    uint64_t changes;
+    std::unordered_map<std::string, NameChain> byName;
+    std::atomic<uint32_t> deliveredHead; // Lock-free stack of slots with a parked result
+};
+
+// Iterators: Cities in display order
+class CityRegistry::Iterator {
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef City value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef City* pointer;
+    typedef City& reference;
+
+    Iterator(CityRegistry* registry, uint32_t index) : registry(registry), index(index) {}
+    City& operator*() const { return registry->slot(index).city; }
+    City* operator->() const { return &registry->slot(index).city; }
+    Iterator& operator++() { index = registry->slot(index).next; return *this; }
+    Iterator operator++(int) { Iterator old = *this; ++*this; return old; }
+    bool operator==(const Iterator& other) const { return index == other.index; }
+    bool operator!=(const Iterator& other) const { return index != other.index; }
+
+private:
+    CityRegistry* registry;
+    uint32_t index;
+};
+
+class CityRegistry::ConstIterator {
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef City value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const City* pointer;
+    typedef const City& reference;
+
+    ConstIterator(const CityRegistry* registry, uint32_t index) : registry(registry), index(index) {}
+    const City& operator*() const { return registry->slot(index).city; }
+    const City* operator->() const { return &registry->slot(index).city; }
+    ConstIterator& operator++() { index = registry->slot(index).next; return *this; }
+    ConstIterator operator++(int) { ConstIterator old = *this; ++*this; return old; }
+    bool operator==(const ConstIterator& other) const { return index == other.index; }
+    bool operator!=(const ConstIterator& other) const { return index != other.index; }
+
+private:
+    const CityRegistry* registry;
+    uint32_t index;
+};
+
+#endif // CITYREGISTRY_H
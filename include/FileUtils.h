@@ -0,0 +1,24 @@
+#ifndef FILEUTILS_H
+#define FILEUTILS_H
+
+#include <cstdint>
+#include <string>
+
+// Function to Replace a File in One Step: write `bytes` to "<path>.tmp", sync it to disk, then rename
+// over `path` and sync the directory, so a crash or power loss leaves either the old file or the new
+// one but never a torn or empty mix.
+bool writeFileAtomically(const std::string& path, const std::string& bytes);
+
+// Function to Append `bytes` to a File (creating it if needed) and sync them to disk before returning
+bool appendToFileDurably(const std::string& path, const std::string& bytes);
+
+const uint64_t fnv1a64_basis = 14695981039346656037ull;
+
+// Function to Fingerprint a File's Contents (64-bit FNV-1a), continuing from `hash` so several
+// files can share one fingerprint; a missing file hashes like an empty one
+uint64_t fileFingerprint(const std::string& path, uint64_t hash = fnv1a64_basis);
+
+// 64-bit FNV-1a over a buffer, continuing from `hash`
+uint64_t fnv1a64(const char* data, size_t length, uint64_t hash = fnv1a64_basis);
+
+#endif // FILEUTILS_H
@@ -0,0 +1,112 @@
+#ifndef GAZETTEER_H
+#define GAZETTEER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// Gazetteer: Offline place index built by the gazetteer_import tool from a GeoNames-style dump.
+// The file holds a table of places and a table of search keys (every name and alternate name,
+// normalized) sorted by key and then by population, so a name resolves with one binary search
+// over the memory-mapped file and the most populous match comes first. Keys sharing a prefix are
+// a contiguous range; a max-population segment tree over the key table, also precomputed in the
+// file, yields the top places of any range without visiting the rest of it. For reverse lookups
+// the file also carries a k-d tree over the places (as points on the unit sphere, in implicit
+// median-split order) and cumulative populations for weighted sampling.
+class Gazetteer {
+public:
+    static const uint32_t version = 3;
+
+    struct Place {
+        std::string name;
+        std::string country;   // ISO 3166 alpha-2 code
+        double lat;
+        double lon;
+        uint32_t population;
+        uint32_t geonameId;
+    };
+
+    // One input row for write()
+    struct Source {
+        Place place;
+        std::vector<std::string> alternateNames;
+    };
+
+    Gazetteer();
+
+    Gazetteer(const Gazetteer&) = delete;
+    Gazetteer& operator=(const Gazetteer&) = delete;
+
+    // Map and validate an index; false (and an empty gazetteer) if it is missing or damaged. Lookups
+    // from other threads may run while open() does (they see a closed gazetteer until it returns);
+    // close() must not race with them.
+    bool open(const std::string& path);
+    void close();
+    // Mark an open() as queued on another thread, so lookups that must not miss the index can wait for it
+    void openPending();
+    // Block until no open() is pending; true if the gazetteer is open
+    bool waitForOpen() const;
+    bool isOpen() const { return ready; }
+    size_t placeCount() const { return places; }
+    size_t keyCount() const { return keys; }
+
+    // Most populous place whose name or alternate name matches, ignoring case and surrounding spaces
+    bool find(const std::string& name, Place& place) const;
+
+    // Up to `limit` distinct places with a name starting with `prefix`, most populous first. When
+    // nothing matches, falls back to prefixes one edit (insert, delete, substitute, swap) away and
+    // sets `fuzzy`.
+    std::vector<Place> suggest(const std::string& prefix, size_t limit, bool* fuzzy = nullptr) const;
+
+    // Place nearest to a coordinate (great-circle distance); false if the gazetteer is not open
+    bool nearest(double lat, double lon, Place& place) const;
+
+    // A place picked with probability proportional to its population; `unit` is uniform in [0, 1)
+    bool samplePlace(double unit, Place& place) const;
+
+    // Build an index file from parsed rows; duplicate names of one place are stored once
+    static bool write(const std::string& path, const std::vector<Source>& sources);
+
+    // Search form of a name: trimmed, inner whitespace collapsed, ASCII letters lowercased
+    static std::string normalize(const std::string& name);
+
+protected:
+    const char* keyData(size_t key, size_t& length) const;
+    uint32_t keyPlace(size_t key) const;
+    Place placeAt(uint32_t index) const;
+    uint32_t keyPopulation(size_t key) const;
+    // First key not less than `prefix` (binary search)
+    size_t lowerBound(const std::string& prefix) const;
+    // First key past the ones starting with `prefix`
+    size_t prefixEnd(const std::string& prefix) const;
+    // Key with the largest population in [first, last), or keyCount() for an empty range
+    size_t rangeMax(size_t first, size_t last) const;
+    // Append the best places of [first, last) to `places` until it holds `limit` of them
+    void topPlaces(size_t first, size_t last, size_t limit, std::vector<uint32_t>& places) const;
+    // Recursive k-d search of the nodes in [first, last), split on axis depth % 3
+    void nearestIn(size_t first, size_t last, size_t depth, const float point[3], size_t& best, float& bestDistance) const;
+
+private:
+    bool openIndex(const std::string& path);
+
+    MappedFile file;
+    std::atomic<bool> ready; // Set last in open(); publishes the tables below
+    mutable std::mutex pendingMutex;
+    mutable std::condition_variable openFinished;
+    bool pending;
+    const char* placeTable;
+    const char* keyTable;
+    const char* maxTree; // keys * 2 entries; leaves at [keys, 2 * keys), node i covers nodes 2i and 2i + 1
+    const char* kdTree;  // places entries of x, y, z, place; the node of a range is its middle element
+    const char* cumulativePopulation; // places entries; entry i sums the weights of places 0..i
+    const char* textArea;
+    size_t places;
+    size_t keys;
+    size_t textBytes;
+};
+
+#endif // GAZETTEER_H
@@ -0,0 +1,37 @@
+#ifndef GEOCODEMISSCACHE_H
+#define GEOCODEMISSCACHE_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Geocode Miss Cache: Place names the geocoding API found no match for, each remembered for its own
+// TTL so a bad favorite or a repeated typo costs one call instead of one per attempt. Only definite
+// "no such place" answers belong here, never network errors. Names are keyed by Gazetteer::normalize()
+// and stamped with wall-clock time so entries survive restarts.
+class GeocodeMissCache {
+public:
+    explicit GeocodeMissCache(std::chrono::seconds ttl);
+
+    // True if `name` missed within the TTL
+    bool contains(const std::string& name) const;
+    void add(const std::string& name);
+
+    // Text file: a header line, then name<TAB>unix time per line; expired entries are dropped
+    bool load(const std::string& path);
+    // Write the file if anything changed since load() or the last save()
+    bool save(const std::string& path);
+
+private:
+    static std::string keyFor(const std::string& name);
+    bool expired(int64_t missedAt, int64_t now) const;
+
+    mutable std::mutex mutex;
+    std::map<std::string, int64_t> misses; // Normalized name -> unix time of the miss
+    std::chrono::seconds timeToLive;
+    bool dirty;
+};
+
+#endif // GEOCODEMISSCACHE_H
@@ -0,0 +1,61 @@
+#ifndef HTTPCLIENTPOOL_H
+#define HTTPCLIENTPOOL_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <httplib.h>
+
+// HTTP Client Pool: Keep-alive clients for a single host, leased out one request at a time.
+// A client keeps its TCP connection open between leases, so a batch only pays for a handful of handshakes.
+class HttpClientPool {
+public:
+    // Exclusive use of one pooled client; the client goes back to the pool when the lease is destroyed
+    class Lease {
+    public:
+        Lease(HttpClientPool* pool, std::unique_ptr<httplib::Client> client);
+        Lease(Lease&& other);
+        ~Lease();
+
+        httplib::Client& operator*() { return *client; }
+        httplib::Client* operator->() { return client.get(); }
+
+    private:
+        HttpClientPool* pool;
+        std::unique_ptr<httplib::Client> client;
+    };
+
+    // Counters used to judge how well connections are being reused
+    struct Stats {
+        size_t requests;           // Leases handed out
+        size_t connectionsOpened;  // TCP connections (handshakes) actually made
+        size_t clientsCreated;     // Clients built since startup
+        size_t idleClients;        // Clients currently parked in the pool
+        size_t activeClients;      // Clients currently leased out
+        double reuseRate() const { return requests == 0 ? 0.0 : 1.0 - static_cast<double>(connectionsOpened) / requests; }
+    };
+
+    HttpClientPool(const std::string& host, size_t maxIdle);
+
+    Lease acquire();
+    Stats stats() const;
+    // Connect to another host from now on; idle clients are dropped. Only for use while no client is
+    // leased (the benchmarks point the app at a local mock before sending anything).
+    void setHost(const std::string& newHost);
+
+private:
+    void release(std::unique_ptr<httplib::Client> client);
+
+    std::string host;
+    size_t maxIdle;
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<httplib::Client>> idle;
+    size_t active;
+    size_t requests;
+    size_t clientsCreated;
+    std::shared_ptr<std::atomic<size_t>> connectionsOpened; // Shared with each client's socket callback
+};
+
+#endif // HTTPCLIENTPOOL_H
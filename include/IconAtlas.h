@@ -0,0 +1,61 @@
+#ifndef ICONATLAS_H
+#define ICONATLAS_H
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Icon Atlas: Every weather icon packed into one RGBA texture, so the results view samples a
+// single texture instead of binding one per icon. build() decodes, downscales and packs the
+// images (with imstb_rectpack) on any thread into a pending atlas; upload() then swaps it in and
+// creates the GL texture on the UI thread, so find() never sees a build in progress. Keys that
+// share an image file share its rectangle.
+class IconAtlas {
+public:
+    // Texture coordinates of one icon inside the atlas
+    struct Icon {
+        float u0, v0, u1, v1;
+    };
+
+    // One key and the image files to try for it, in order; the first that decodes is used
+    struct Source {
+        std::string key;
+        std::vector<std::string> files;
+    };
+
+    IconAtlas();
+
+    IconAtlas(const IconAtlas&) = delete;
+    IconAtlas& operator=(const IconAtlas&) = delete;
+
+    // Decode every source, shrink each image to fit `cellSize` pixels and pack them; false if no image decoded
+    bool build(const std::vector<Source>& sources, int cellSize);
+    // Swap in the atlas of a finished build() and create its texture (UI thread, GL context current);
+    // true once a texture exists
+    bool upload();
+    // Free the texture (UI thread, before the GL context goes away)
+    void release();
+
+    bool find(const std::string& key, Icon& icon) const;
+    unsigned int texture() const { return textureId; }
+
+private:
+    // A packed atlas: handed from build() to upload(), then the one find() reads
+    struct Packed {
+        std::vector<unsigned char> pixels; // RGBA, kept only until upload()
+        int width;
+        int height;
+        std::map<std::string, Icon> icons;
+    };
+
+    std::mutex pendingMutex;
+    Packed pending;
+    std::atomic<bool> pendingReady; // Set by build() once `pending` holds a new atlas
+    Packed current;  // UI thread only
+    bool built;      // `current` holds an atlas
+    unsigned int textureId;
+};
+
+#endif // ICONATLAS_H
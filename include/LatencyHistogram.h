@@ -0,0 +1,29 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+// Latency Histogram: Request latencies in log-spaced buckets (about 10% wide, 1 ms to ~3 min),
+// cheap enough to record every request and read percentiles every frame.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(std::chrono::milliseconds latency);
+    // Upper edge of the bucket holding the given percentile (0-100); zero when empty
+    std::chrono::milliseconds percentile(double p) const;
+    size_t count() const;
+    void reset();
+
+private:
+    static size_t bucketFor(double ms);
+    static double bucketUpperBound(size_t bucket);
+
+    mutable std::mutex mutex;
+    std::vector<size_t> buckets;
+    size_t samples;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -10,6 +10,8 @@
 #include <mutex>
 #include <thread>
 #include <map>
+#include <unordered_map>
+#include <random>
 #include "imgui.h"
 #include <imgui/backend/imgui_impl_glfw.h>
 #include <imgui/backend/imgui_impl_opengl3.h>
@@ -17,39 +19,188 @@
 #include <GLFW/glfw3.h>
 #include <json.hpp>
 #include <httplib.h>
+#include "WorkerPool.h"
+#include "AsyncJob.h"
+#include "HttpClientPool.h"
+#include "LatencyHistogram.h"
+#include "CancellationToken.h"
+#include "RateLimiter.h"
+#include "SingleFlight.h"
+#include "WeatherSnapshot.h"
+#include "CityRegistry.h"
+#include "WeatherCache.h"
+#include "WeatherStore.h"
+#include "Gazetteer.h"
+#include "GeocodeMissCache.h"
+#include "IconAtlas.h"
+#include "StartupProfiler.h"
+#include "AppSnapshot.h"
 
 // Constants: These define constant values used throughout the program.
 extern const std::string base_url;
+extern const std::string api_host;
 extern const std::string favorites_file;
+extern const std::string app_state_file;
+extern const std::string gazetteer_file;
+extern const std::string startup_profile_file;
+extern const std::string startup_benchmark_file;
+extern const int default_startup_benchmark_runs;
+extern const int app_state_save_interval_seconds;
+extern const std::string favorites_header;
+extern const int favorites_version;
+extern const std::string favorites_journal_file;
+extern const std::string geocode_miss_file;
+extern const int geocode_miss_ttl_hours;
+extern const std::string favorites_journal_header;
+extern const size_t favorites_journal_min_compact;
+extern const std::string weather_store_file;
 extern std::string api_key;
+extern const size_t max_fetch_workers;
+extern const size_t max_geocode_workers;
+extern const double random_city_jitter_degrees;
+extern const size_t max_place_suggestions;
+extern const std::string weather_icon_dir;
+extern const int weather_icon_size;
+extern const size_t max_group_size;
+extern const int weather_cache_ttl_seconds;
+extern const size_t weather_cache_capacity;
+extern const size_t weather_store_capacity;
+extern const int weather_store_max_age_hours;
+extern const double api_calls_per_minute;
+extern const double api_call_burst;
 
-// Struct Definition: Defines a data structure to hold information about a city.
-struct City {
+// Weather Target: What a fetch job needs to know about one city, copied on the UI thread when the
+// job is planned so workers never read the registry; the result goes back by handle.
+struct WeatherTarget {
+    CityHandle city;
+    std::string name;
+    double lat;
+    double lon;
+    int owmId;
+};
+
+// Weather Reply: What one weather request (single or group) produced, shared by coalesced callers.
+// Cancelled means the caller that sent it gave up; callers that are still live send their own.
+struct WeatherReply {
+    enum Status { Ok, Failed, Cancelled };
+    Status status;
+    std::vector<WeatherSnapshot> snapshots; // One per city in the response
+};
+
+// Request Policy: How hard apiGet tries before giving up on a request.
+struct RequestPolicy {
+    std::chrono::milliseconds deadline;     // Total time allowed, retries included
+    int maxRetries;                         // Extra attempts after a transport error, 429 or 5xx
+    std::chrono::milliseconds baseBackoff;  // First retry waits up to this long (full jitter), doubling each time
+    std::chrono::milliseconds maxBackoff;
+    bool hedge;                             // Send a second copy once the first outlives the p95 latency
+};
+
+// Counters describing what the request policy had to do
+struct RequestStats {
+    std::atomic<size_t> attempts;
+    std::atomic<size_t> retries;
+    std::atomic<size_t> hedgesSent;
+    std::atomic<size_t> hedgesWon;
+    std::atomic<size_t> hedgesStopped; // Hedges still running when the primary answered, closed by it
+    std::atomic<size_t> deadlinesExceeded;
+};
+
+// Weather Batch: The fetch jobs started by one "See Weather" click. Cancelling the token drops queued
+// jobs and aborts requests that are still connecting or reading. Each job also has a token of its own,
+// cancelled with the batch, so removing a city can abort just the requests made for it.
+struct WeatherBatch {
+    struct Job {
+        std::shared_ptr<CancellationToken> token;
+        size_t liveCities; // Cities of the job not removed yet (UI thread)
+    };
+
+    std::shared_ptr<CancellationToken> token;
+    std::atomic<int> queued;    // Jobs the popup waits for (cache misses)
+    std::atomic<int> finished;
+    std::vector<Job> jobs;      // UI thread only
+    std::unordered_multimap<uint64_t, size_t> jobsByCity; // Handle (index and generation) to index in `jobs`
+
+    WeatherBatch() : token(std::make_shared<CancellationToken>()), queued(0), finished(0) {}
+    bool done() const { return finished == queued; }
+};
+
+// Geocode Result: A place found by a background lookup, applied to `cities` on the UI thread.
+struct GeocodeResult {
+    bool found;
     std::string name;
     double lon;
     double lat;
-    bool selected;
-    nlohmann::json weatherData;
 };
+typedef std::shared_ptr<AsyncJob<GeocodeResult>> GeocodeJob;
+
+// Lookup Outcome: What a name lookup learned. Failed means no answer at all (offline, timeout, 401/429,
+// 5xx or cancelled), which says nothing about whether the place exists.
+enum class LookupOutcome { Found, NotFound, Failed };
 
 // Initial List of Cities
-extern std::vector<City> cities;
+extern CityRegistry cities;
 
 // Global Variables for Threading
-extern std::mutex weatherDataMutex;
-extern std::atomic<int> threadsFinished;
+extern WorkerPool cancelPool;
+extern WorkerPool hedgePool;
+extern WorkerPool fetchPool;
+extern WorkerPool lookupPool;
+extern WorkerPool geocodePool;
+extern WorkerPool stateWriter;
+extern HttpClientPool apiClientPool;
+extern RateLimiter apiRateLimiter;
+extern const RequestPolicy default_request_policy;
+extern LatencyHistogram apiLatency;
+extern RequestStats apiRequestStats;
+extern SingleFlight<WeatherReply> weatherFlights;
+extern WeatherCache weatherCache;
+extern WeatherStore weatherStore;
+extern Gazetteer gazetteer;
+extern GeocodeMissCache geocodeMisses;
+extern IconAtlas iconAtlas;
+extern size_t favoritesJournalRecords;
 
 // Function Prototypes
 std::string readApiKeyFromFile(const std::string& filePath);
-void getWeatherDataForEach(City& city);
-bool validateCity(const std::string& cityName, double& lon, double& lat);
-void loadMyCityList(std::vector<City>& cities, std::set<std::string>& favorites);
-void saveMyCityList(const std::set<std::string>& favorites);
-void addToMyCityList(const std::vector<City>& cities, std::set<std::string>& favorites);
-void removeFromMyList(const std::vector<City>& cities, std::set<std::string>& favorites);
-std::vector<City> filterMyList(const std::vector<City>& cities, const std::set<std::string>& favorites);
-std::string unixToHHMM(int unixTime);
-void uncheckAllCities(std::vector<City>& cities);
-void addNewPlace(const std::string& cityName); // Updated function to prevent duplicates
+httplib::Result apiGet(const std::string& path, const RequestPolicy& policy = default_request_policy,
+    const std::shared_ptr<CancellationToken>& token = nullptr);
+std::string locationKey(double lat, double lon);
+void rememberWeather(const std::string& key, const WeatherSnapshot& data);
+void restoreWeather(std::vector<WeatherStore::Record> records);
+void loadPersistedWeather();
+WeatherReply fetchWeatherAt(double lat, double lon, const std::shared_ptr<CancellationToken>& token);
+void getWeatherDataForEach(const WeatherTarget& target, const std::shared_ptr<CancellationToken>& token);
+void getWeatherDataForGroup(const std::vector<WeatherTarget>& group, const std::shared_ptr<CancellationToken>& token);
+WeatherCache::Lookup serveCachedWeather(City& city);
+std::vector<std::vector<WeatherTarget>> planWeatherBatches(const std::vector<WeatherTarget>& targets);
+std::shared_ptr<WeatherBatch> startWeatherBatch(const std::vector<City*>& targets);
+void cancelWeatherBatch(const std::shared_ptr<WeatherBatch>& batch);
+void cancelCityRequests(const std::shared_ptr<WeatherBatch>& batch, CityHandle city);
+LookupOutcome validateCity(const std::string& cityName, double& lon, double& lat,
+    const std::shared_ptr<CancellationToken>& token = nullptr);
+GeocodeJob startCityLookup(const std::string& cityName, WorkerPool& pool = lookupPool);
+GeocodeJob startReverseLookup(double lat, double lon);
+bool randomGazetteerPlace(std::mt19937& rng, GeocodeResult& result);
+std::map<std::string, GeocodeJob> loadAppState(std::set<std::string>& favorites, std::map<std::string, bool>& selectedFavorites);
+AppSnapshot captureAppState(const std::set<std::string>& favorites, const std::map<std::string, bool>& selectedFavorites);
+void addCachedWeather(AppSnapshot& snapshot);
+void saveAppState(const std::set<std::string>& favorites, const std::map<std::string, bool>& selectedFavorites, bool wait);
+City parseFavoriteLine(const std::string& line);
+std::string formatFavoriteLine(const City& city);
+uint64_t favoritesFingerprint();
+std::map<std::string, GeocodeJob> loadMyCityList(CityRegistry& cities, std::set<std::string>& favorites);
+void saveMyCityList(const CityRegistry& cities, const std::set<std::string>& favorites);
+void journalFavorites(const std::vector<const City*>& added, const std::vector<std::string>& removed,
+    const CityRegistry& cities, const std::set<std::string>& favorites);
+bool applyFavoriteLookups(std::map<std::string, GeocodeJob>& lookups, CityRegistry& cities,
+    std::set<std::string>& favorites, std::map<std::string, bool>& selectedFavorites);
+void addToMyCityList(const CityRegistry& cities, std::set<std::string>& favorites);
+void removeFromMyList(const CityRegistry& cities, std::set<std::string>& favorites);
+std::vector<City> filterMyList(const CityRegistry& cities, const std::set<std::string>& favorites);
+std::vector<IconAtlas::Source> weatherIconSources();
+std::string weatherIconKey(const WeatherSnapshot& weatherData);
+void uncheckAllCities(CityRegistry& cities);
+void addNewPlace(const GeocodeResult& place);
 
 #endif // MUSAWEATHERAPP_H
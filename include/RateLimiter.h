@@ -0,0 +1,53 @@
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include "CancellationToken.h"
+
+// Rate Limiter: Gate every upstream call so we stay inside the API key's per-minute budget.
+// A token bucket caps the call rate, and an AIMD limit on concurrent calls halves on 429/5xx
+// responses and grows back by one slot for every `limit` successful calls.
+class RateLimiter {
+public:
+    struct Stats {
+        size_t callsLastMinute;   // Calls started in the trailing 60 seconds
+        double callsPerMinute;    // Configured budget
+        double tokens;            // Calls that may start right now
+        double concurrencyLimit;  // Current AIMD limit
+        size_t inFlight;
+        size_t throttled;         // 429 and 5xx responses seen
+    };
+
+    RateLimiter(double callsPerMinute, double burst, size_t maxConcurrency);
+
+    // Block until a token and a concurrency slot are available; false if `token` was cancelled first
+    bool acquire(const CancellationToken* token = nullptr);
+    // Report the outcome of a call started with acquire(); status 0 means no response at all
+    void release(int status);
+
+    void setRate(double callsPerMinute);
+    Stats stats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void refill(Clock::time_point now);
+    void pruneRecentCalls(Clock::time_point now) const;
+
+    mutable std::mutex mutex;
+    std::condition_variable slotFreed;
+    double ratePerSecond;
+    double bucketSize;
+    double tokens;
+    Clock::time_point lastRefill;
+    double maxConcurrency;
+    double concurrencyLimit;
+    size_t inFlight;
+    size_t throttled;
+    mutable std::deque<Clock::time_point> recentCalls;
+};
+
+#endif // RATELIMITER_H
@@ -0,0 +1,63 @@
+#ifndef SINGLEFLIGHT_H
+#define SINGLEFLIGHT_H
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Single Flight: Concurrent calls for the same key share one execution of the work.
+// The first caller runs it; everyone who arrives while it is in flight waits for that result.
+template <typename T>
+class SingleFlight {
+public:
+    SingleFlight() : coalescedCount(0) {}
+
+    T run(const std::string& key, const std::function<T()>& work) {
+        std::shared_future<T> pending;
+        std::promise<T> promise;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = inFlight.find(key);
+            if (it != inFlight.end()) {
+                pending = it->second;
+                coalescedCount++;
+            }
+            else {
+                inFlight[key] = promise.get_future().share();
+            }
+        }
+        if (pending.valid()) {
+            return pending.get();
+        }
+
+        try {
+            T result = work();
+            finish(key);
+            promise.set_value(result);
+            return result;
+        }
+        catch (...) {
+            finish(key);
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+    // Number of calls that were served by another caller's request
+    size_t coalesced() const { return coalescedCount; }
+
+private:
+    void finish(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight.erase(key);
+    }
+
+    std::mutex mutex;
+    std::map<std::string, std::shared_future<T>> inFlight;
+    std::atomic<size_t> coalescedCount;
+};
+
+#endif // SINGLEFLIGHT_H
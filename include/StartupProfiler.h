@@ -0,0 +1,52 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <json.hpp>
+#include "WorkerPool.h"
+
+// Startup Profiler: Times each phase of startup on the monotonic clock. Foreground phases run
+// back to back on the UI thread, each ending at the next mark(); background phases run on a
+// worker pool and are timed from submission to completion. Times are milliseconds since the
+// profiler was created.
+class StartupProfiler {
+public:
+    struct Phase {
+        std::string name;
+        double startMs;
+        double durationMs;
+        bool background;
+    };
+
+    StartupProfiler();
+
+    // End the foreground phase that began at the previous mark (or at construction) under `name`
+    void mark(const std::string& name);
+    // Run `work` on `pool` as a background phase; the job outlives the profiler safely
+    void runInBackground(WorkerPool& pool, const std::string& name, std::function<void()> work);
+    // Block until every background phase has finished
+    void waitForBackground() const;
+
+    double elapsedMs() const;
+    std::vector<Phase> phases() const;
+    size_t pendingBackground() const;
+
+    // Table of phases for the console, and the same data as JSON
+    void report(std::ostream& out) const;
+    nlohmann::json toJson() const;
+
+    // Percentiles of every phase across several profiled runs, for --startup-benchmark
+    static nlohmann::json summarize(const std::vector<std::vector<Phase>>& runs);
+    static void reportSummary(const nlohmann::json& summary, std::ostream& out);
+
+private:
+    struct State;
+    std::shared_ptr<State> state;
+};
+
+#endif // STARTUPPROFILER_H
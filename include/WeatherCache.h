@@ -0,0 +1,57 @@
+#ifndef WEATHERCACHE_H
+#define WEATHERCACHE_H
+
+#include <chrono>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include "WeatherSnapshot.h"
+
+// Weather Cache: Last parsed response per location (see locationKey) with a freshness window.
+// Entries older than the TTL are still returned, flagged stale, so the UI can show them while a refresh runs.
+// At most `capacity` locations are kept; adding one more evicts the one least recently looked up or stored.
+class WeatherCache {
+public:
+    enum class Lookup { Miss, Fresh, Stale };
+
+    struct Stats {
+        size_t hits;     // Fresh entries served without a network call
+        size_t stale;    // Expired entries served while being refreshed
+        size_t misses;   // Locations with nothing cached
+        size_t entries;
+        size_t evicted;  // Entries dropped to stay within the capacity
+    };
+
+    WeatherCache(std::chrono::seconds ttl, size_t capacity);
+
+    Lookup get(const std::string& key, WeatherSnapshot& data);
+    // `age` backdates the entry, e.g. for data restored from disk
+    void put(const std::string& key, const WeatherSnapshot& data, std::chrono::seconds age = std::chrono::seconds(0));
+    // Copy out an entry and its age without counting it as a hit or miss; false if absent
+    bool peek(const std::string& key, WeatherSnapshot& data, std::chrono::seconds& age) const;
+
+    std::chrono::seconds ttl() const;
+    Stats stats() const;
+
+private:
+    struct Entry {
+        WeatherSnapshot data;
+        std::chrono::steady_clock::time_point fetchedAt;
+        std::list<std::string>::iterator recent; // Position in `recency`
+    };
+
+    void touch(Entry& entry);
+
+    mutable std::mutex mutex;
+    std::map<std::string, Entry> entries;
+    std::list<std::string> recency; // Keys, most recently used first
+    std::chrono::seconds timeToLive;
+    size_t maxEntries;
+    size_t evictedCount;
+    size_t hitCount;
+    size_t staleCount;
+    size_t missCount;
+};
+
+#endif // WEATHERCACHE_H
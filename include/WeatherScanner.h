@@ -0,0 +1,52 @@
+#ifndef WEATHERSCANNER_H
+#define WEATHERSCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Text Span: A run of bytes inside a buffer owned by someone else (no copy, not NUL-terminated)
+struct TextSpan {
+    const char* data;
+    size_t size;
+};
+
+// Weather Fields: What WeatherScanner pulls out of one current-weather response. The spans point
+// into the scanned body. Fields missing from the body are zero / empty.
+struct WeatherFields {
+    bool hasMain;         // The response has a "main" object (otherwise it is not weather data)
+    int64_t cityId;
+    int64_t conditionId;
+    TextSpan icon;
+    TextSpan description;
+    double temperature;
+    int64_t humidity;
+    double windSpeed;
+    int64_t sunrise;
+    int64_t sunset;
+};
+
+// Weather Scanner: Parser specialised for the OpenWeatherMap current-weather schema, for the hot
+// refresh path. A SIMD pass (AVX2 or SSE2, whichever the compiler targets, else a scalar loop)
+// indexes the quotes and the structural characters outside strings, 64 bytes at a time; a walk over
+// that index then checks the JSON grammar and picks out the fields WeatherSnapshot needs. Numbers are
+// parsed in place and strings come back as spans into the body, so a scan allocates nothing once its
+// per-thread index buffer has grown. Anything it does not handle itself (escape sequences, deep
+// nesting, malformed text) is reported as Unsupported so the caller can use the SAX parser instead.
+// Compiled in with the MWA_FAST_WEATHER_PARSER CMake option; MWA_SCANNER_FORCE_SCALAR picks the scalar
+// loop even when the compiler targets SIMD.
+class WeatherScanner {
+public:
+    enum Result {
+        Parsed,       // Valid JSON with a "main" object; `fields` is filled in
+        NotWeather,   // Valid JSON object without a "main" object (e.g. an error body)
+        Unsupported   // Not handled here; parse the body another way
+    };
+
+    static Result scan(const std::string& body, WeatherFields& fields);
+
+    // The structural scanner compiled in: "avx2", "sse2" or "scalar"
+    static const char* kernel();
+};
+
+#endif // WEATHERSCANNER_H
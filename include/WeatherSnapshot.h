@@ -0,0 +1,48 @@
+#ifndef WEATHERSNAPSHOT_H
+#define WEATHERSNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <json.hpp>
+
+// Weather Snapshot: The fields the app shows from one current-weather response, parsed once on the
+// worker thread that received it so the UI reads plain fields instead of walking a JSON tree every
+// frame. A value-initialized snapshot (valid == false) means "no data". The description is interned:
+// each distinct text is stored once for the life of the process and snapshots point at it, so copies
+// are cheap and never allocate.
+struct WeatherSnapshot {
+    bool valid;
+    int cityId;           // OpenWeatherMap city id (0 = not in the response)
+    int conditionId;      // Weather condition code, e.g. 500 = light rain
+    char icon[4];         // Icon code such as "10n", NUL-terminated
+    const char* description;
+    double temperature;   // Kelvin
+    int humidity;         // Percent
+    double windSpeed;     // m/s
+    int64_t sunrise;      // Unix time
+    int64_t sunset;
+    char sunriseText[6];  // Local HH:MM, formatted once when parsed (localtime is slow per frame)
+    char sunsetText[6];
+
+    // Pull the shown fields out of a parsed response; invalid if it has no "main" block
+    static WeatherSnapshot fromJson(const nlohmann::json& data);
+    // Same fields straight from the response text with a SAX pass (or WeatherScanner when built
+    // with MWA_FAST_WEATHER_PARSER), building no JSON tree; false if the text is not JSON or has no
+    // "main" block
+    static bool parse(const std::string& body, WeatherSnapshot& snapshot);
+    // Every entry of a /group response's "list" that has a "main" block; false if there is no list
+    static bool parseList(const std::string& body, std::vector<WeatherSnapshot>& snapshots);
+
+    // Compact binary form for the weather store and the app snapshot; decode() rejects anything else
+    std::string encode() const;
+    static bool decode(const std::string& bytes, WeatherSnapshot& snapshot);
+};
+
+// Function to Intern a Description: the same text always yields the same pointer, valid until exit
+const char* internWeatherText(const std::string& text);
+// The same for a run of bytes; each thread remembers the texts it has interned, so a repeated text
+// costs no allocation and no lock
+const char* internWeatherText(const char* data, size_t size);
+
+#endif // WEATHERSNAPSHOT_H
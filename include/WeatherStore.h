@@ -0,0 +1,54 @@
+#ifndef WEATHERSTORE_H
+#define WEATHERSTORE_H
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Weather Store: On-disk copy of the weather cache so last-known data survives a restart.
+// The file is a header followed by fixed-size slots, one encoded snapshot per location. It is
+// memory-mapped and validated at startup; each slot carries a checksum so a torn write only
+// loses that one slot. Slots older than maxAge are dropped and, once the file holds `capacity`
+// slots, the oldest one is overwritten.
+class WeatherStore {
+public:
+    struct Record {
+        std::string key;     // locationKey of the response
+        std::string body;    // WeatherSnapshot::encode() of the response
+        int64_t fetchedAt;   // Unix time the response was received
+    };
+
+    static const uint32_t slot_size = 1024;
+
+    WeatherStore(const std::string& path, size_t capacity, std::chrono::seconds maxAge);
+
+    // Map the file and return every intact, unexpired record; must run before save()
+    std::vector<Record> load();
+
+    // Write one response into its location's slot (or a free/oldest slot for a new location)
+    bool save(const std::string& key, const std::string& body, int64_t fetchedAt);
+
+private:
+    struct SlotInfo {
+        uint32_t slot;
+        int64_t fetchedAt;
+    };
+
+    bool resetFile();
+    uint32_t chooseSlot(const std::string& key);
+
+    std::string path;
+    size_t capacity;
+    std::chrono::seconds maxAge;
+    std::mutex mutex;
+    std::fstream file;
+    std::map<std::string, SlotInfo> index;
+    std::vector<uint32_t> freeSlots;
+    uint32_t slotsInFile;
+};
+
+#endif // WEATHERSTORE_H
@@ -0,0 +1,39 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker Pool: A set of long-lived threads that drain a shared job queue.
+// Workers are started lazily up to the concurrency cap and reused for every batch.
+class WorkerPool {
+public:
+    explicit WorkerPool(size_t maxWorkers);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Queue a job; it runs on the first free worker
+    void submit(std::function<void()> job);
+
+    size_t maxWorkers() const;
+
+private:
+    void workerLoop();
+
+    mutable std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::deque<std::function<void()>> jobs;
+    std::vector<std::thread> workers;
+    size_t workerCap;
+    size_t workersAlive;
+    size_t workersIdle;
+    bool stopping;
+};
+
+#endif // WORKERPOOL_H
@@ -0,0 +1,137 @@
+#include "AppSnapshot.h"
+#include "FileUtils.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Header: magic, version, place count, weather count, favorites hash, payload size, payload checksum.
+// Payload: fixed-size place records, then weather records, then the names and bodies they point into.
+const char snapshot_magic[4] = { 'M', 'W', 'A', 'S' };
+const size_t header_size = 40;
+const size_t place_record_size = 32;   // lon, lat, owmId, name offset, name length, flags, padding
+const size_t weather_record_size = 24; // place, body offset, body length, padding, fetchedAt
+
+template <typename T>
+void writeField(std::string& out, size_t offset, T value) {
+    std::memcpy(&out[offset], &value, sizeof(value));
+}
+
+template <typename T>
+T readField(const char* base, size_t offset) {
+    T value;
+    std::memcpy(&value, base + offset, sizeof(value));
+    return value;
+}
+
+}
+
+AppSnapshot::AppSnapshot() : favoritesHash(0) {
+}
+
+std::string AppSnapshot::serialize() const {
+    size_t recordBytes = places.size() * place_record_size + weather.size() * weather_record_size;
+    size_t textBytes = 0;
+    for (const auto& place : places) {
+        textBytes += place.name.size();
+    }
+    for (const auto& entry : weather) {
+        textBytes += entry.body.size();
+    }
+
+    std::string out(header_size + recordBytes + textBytes, '\0');
+    size_t record = header_size;
+    size_t text = 0; // Offset into the text area that follows the records
+    char* textArea = &out[header_size + recordBytes];
+    for (const auto& place : places) {
+        size_t nameLength = std::min<size_t>(place.name.size(), 0xFFFF);
+        writeField(out, record, place.lon);
+        writeField(out, record + 8, place.lat);
+        writeField(out, record + 16, place.owmId);
+        writeField(out, record + 20, static_cast<uint32_t>(text));
+        writeField(out, record + 24, static_cast<uint16_t>(nameLength));
+        writeField(out, record + 26, place.flags);
+        std::memcpy(textArea + text, place.name.data(), nameLength);
+        text += nameLength;
+        record += place_record_size;
+    }
+    for (const auto& entry : weather) {
+        writeField(out, record, entry.place);
+        writeField(out, record + 4, static_cast<uint32_t>(text));
+        writeField(out, record + 8, static_cast<uint32_t>(entry.body.size()));
+        writeField(out, record + 16, entry.fetchedAt);
+        std::memcpy(textArea + text, entry.body.data(), entry.body.size());
+        text += entry.body.size();
+        record += weather_record_size;
+    }
+    out.resize(header_size + recordBytes + text); // Names longer than the length field allows were cut
+
+    uint64_t payloadBytes = out.size() - header_size;
+    std::memcpy(&out[0], snapshot_magic, sizeof(snapshot_magic));
+    writeField(out, 4, version);
+    writeField(out, 8, static_cast<uint32_t>(places.size()));
+    writeField(out, 12, static_cast<uint32_t>(weather.size()));
+    writeField(out, 16, favoritesHash);
+    writeField(out, 24, payloadBytes);
+    writeField(out, 32, fnv1a64(out.data() + header_size, payloadBytes));
+    return out;
+}
+
+// Function to Load a Snapshot: every offset is bounds-checked, so a damaged file is rejected, never trusted
+bool AppSnapshot::load(const std::string& path) {
+    places.clear();
+    weather.clear();
+    favoritesHash = 0;
+
+    MappedFile mapped;
+    if (!mapped.open(path) || mapped.size() < header_size
+        || std::memcmp(mapped.data(), snapshot_magic, sizeof(snapshot_magic)) != 0) {
+        return false;
+    }
+    const char* base = mapped.data();
+    uint32_t fileVersion = readField<uint32_t>(base, 4);
+    uint64_t placeCount = readField<uint32_t>(base, 8);
+    uint64_t weatherCount = readField<uint32_t>(base, 12);
+    uint64_t payloadBytes = readField<uint64_t>(base, 24);
+    uint64_t recordBytes = placeCount * place_record_size + weatherCount * weather_record_size;
+    if (fileVersion != version || payloadBytes != mapped.size() - header_size || recordBytes > payloadBytes
+        || fnv1a64(base + header_size, payloadBytes) != readField<uint64_t>(base, 32)) {
+        return false;
+    }
+    const char* textArea = base + header_size + recordBytes;
+    uint64_t textBytes = payloadBytes - recordBytes;
+
+    places.resize(placeCount);
+    const char* record = base + header_size;
+    for (auto& place : places) {
+        uint64_t nameOffset = readField<uint32_t>(record, 20);
+        uint64_t nameLength = readField<uint16_t>(record, 24);
+        if (nameOffset + nameLength > textBytes) {
+            places.clear();
+            return false;
+        }
+        place.lon = readField<double>(record, 0);
+        place.lat = readField<double>(record, 8);
+        place.owmId = readField<int32_t>(record, 16);
+        place.name.assign(textArea + nameOffset, nameLength);
+        place.flags = readField<uint8_t>(record, 26);
+        record += place_record_size;
+    }
+    weather.resize(weatherCount);
+    for (auto& entry : weather) {
+        uint64_t bodyOffset = readField<uint32_t>(record, 4);
+        uint64_t bodyLength = readField<uint32_t>(record, 8);
+        entry.place = readField<uint32_t>(record, 0);
+        if (entry.place >= placeCount || bodyOffset + bodyLength > textBytes) {
+            places.clear();
+            weather.clear();
+            return false;
+        }
+        entry.fetchedAt = readField<int64_t>(record, 16);
+        entry.body.assign(textArea + bodyOffset, bodyLength);
+        record += weather_record_size;
+    }
+    favoritesHash = readField<uint64_t>(base, 16);
+    return true;
+}
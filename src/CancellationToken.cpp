@@ -0,0 +1,72 @@
+#include "CancellationToken.h"
+#include "WorkerPool.h"
+
+CancellationToken::CancellationToken() : cancelled(false), nextId(1) {
+}
+
+void CancellationToken::cancel() {
+    requestCancel();
+    runCallbacks();
+}
+
+void CancellationToken::requestCancel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled = true;
+    }
+    wake.notify_all();
+}
+
+// Callbacks run under the lock so removeCallback() cannot return while one is still running
+void CancellationToken::runCallbacks() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!cancelled) {
+        return;
+    }
+    for (auto& callback : callbacks) {
+        callback.second();
+    }
+    callbacks.clear();
+}
+
+void CancellationToken::cancelInBackground(WorkerPool& pool) {
+    requestCancel();
+    std::shared_ptr<CancellationToken> self = shared_from_this();
+    pool.submit([self]() { self->runCallbacks(); });
+}
+
+bool CancellationToken::waitFor(std::chrono::milliseconds duration) const {
+    std::unique_lock<std::mutex> lock(mutex);
+    return wake.wait_for(lock, duration, [this]() { return cancelled.load(); });
+}
+
+size_t CancellationToken::onCancel(std::function<void()> callback) const {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!cancelled) {
+            size_t id = nextId++;
+            callbacks[id] = std::move(callback);
+            return id;
+        }
+    }
+    callback();
+    return 0;
+}
+
+void CancellationToken::removeCallback(size_t id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    callbacks.erase(id);
+}
+
+CancelRegistration::CancelRegistration(const CancellationToken* token, std::function<void()> callback)
+    : token(token), id(0) {
+    if (token) {
+        id = token->onCancel(std::move(callback));
+    }
+}
+
+CancelRegistration::~CancelRegistration() {
+    if (token && id != 0) {
+        token->removeCallback(id);
+    }
+}
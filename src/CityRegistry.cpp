@@ -0,0 +1,226 @@
+#include "CityRegistry.h"
+#include <iostream>
+
+CityRegistry::CityRegistry()
+    : chunkCount(0), slotsUsed(0), freeHead(none), head(none), tail(none), count(0), changes(0), deliveredHead(none) {
+    for (size_t i = 0; i < max_chunks; i++) {
+        chunks[i] = nullptr;
+    }
+}
+
+CityRegistry::CityRegistry(std::initializer_list<City> initial) : CityRegistry() {
+    for (const auto& city : initial) {
+        add(city);
+    }
+}
+
+CityRegistry::~CityRegistry() {
+    for (size_t i = 0; i < chunkCount; i++) {
+        delete[] chunks[i];
+    }
+}
+
+bool CityRegistry::live(CityHandle handle) const {
+    return handle.index < slotsUsed && handle.valid() && slot(handle.index).generation == handle.generation;
+}
+
+CityHandle CityRegistry::add(const City& city) {
+    uint32_t index = freeHead;
+    if (index != none) {
+        freeHead = slot(index).nextFree;
+    }
+    else {
+        if (slotsUsed == chunkCount * chunk_size) {
+            if (chunkCount == max_chunks) {
+                std::cerr << "City registry is full; " << city.name << " was not added" << std::endl;
+                return CityHandle();
+            }
+            Slot* chunk = new Slot[chunk_size];
+            for (size_t i = 0; i < chunk_size; i++) {
+                chunk[i].generation = 0;
+                chunk[i].queued = false;
+                chunk[i].nextDelivered = none;
+                chunk[i].deliveredFor = CityHandle();
+                chunk[i].delivered = WeatherSnapshot();
+            }
+            chunks[chunkCount++] = chunk;
+        }
+        index = slotsUsed++;
+    }
+
+    Slot& s = slot(index);
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.generation++;
+    }
+    s.city = city;
+    s.city.handle.index = index;
+    s.city.handle.generation = s.generation;
+    s.prev = tail;
+    s.next = none;
+    if (tail != none) {
+        slot(tail).next = index;
+    }
+    else {
+        head = index;
+    }
+    tail = index;
+
+    // Cities are always appended, so the end of the name's chain is also the end in display order
+    s.nextSameName = none;
+    auto named = byName.find(s.city.name);
+    if (named != byName.end()) {
+        s.prevSameName = named->second.last;
+        slot(named->second.last).nextSameName = index;
+        named->second.last = index;
+    }
+    else {
+        s.prevSameName = none;
+        NameChain chain = { index, index };
+        byName.emplace(s.city.name, chain);
+    }
+    count++;
+    changes++;
+    return s.city.handle;
+}
+
+bool CityRegistry::remove(CityHandle handle) {
+    if (!live(handle)) {
+        return false;
+    }
+    Slot& s = slot(handle.index);
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.generation++; // Results still in flight for this city are refused from now on
+    }
+    if (s.prev != none) {
+        slot(s.prev).next = s.next;
+    }
+    else {
+        head = s.next;
+    }
+    if (s.next != none) {
+        slot(s.next).prev = s.prev;
+    }
+    else {
+        tail = s.prev;
+    }
+    if (s.prevSameName != none && s.nextSameName != none) {
+        slot(s.prevSameName).nextSameName = s.nextSameName;
+        slot(s.nextSameName).prevSameName = s.prevSameName;
+    }
+    else {
+        auto named = byName.find(s.city.name);
+        if (s.prevSameName == none && s.nextSameName == none) {
+            byName.erase(named);
+        }
+        else if (s.prevSameName == none) {
+            named->second.first = s.nextSameName;
+            slot(s.nextSameName).prevSameName = none;
+        }
+        else {
+            named->second.last = s.prevSameName;
+            slot(s.prevSameName).nextSameName = none;
+        }
+    }
+    s.city = City(); // Free the name now rather than when the slot is reused
+    s.nextFree = freeHead;
+    freeHead = handle.index;
+    count--;
+    changes++;
+    return true;
+}
+
+void CityRegistry::clear() {
+    while (head != none) {
+        remove(slot(head).city.handle);
+    }
+}
+
+City* CityRegistry::get(CityHandle handle) {
+    return live(handle) ? &slot(handle.index).city : nullptr;
+}
+
+const City* CityRegistry::get(CityHandle handle) const {
+    return live(handle) ? &slot(handle.index).city : nullptr;
+}
+
+uint32_t CityRegistry::findIndex(const std::string& name) const {
+    auto named = byName.find(name);
+    return named != byName.end() ? named->second.first : none;
+}
+
+City* CityRegistry::find(const std::string& name) {
+    uint32_t index = findIndex(name);
+    return index != none ? &slot(index).city : nullptr;
+}
+
+const City* CityRegistry::find(const std::string& name) const {
+    uint32_t index = findIndex(name);
+    return index != none ? &slot(index).city : nullptr;
+}
+
+bool CityRegistry::deliverWeather(CityHandle handle, const WeatherSnapshot& data, const std::shared_ptr<CancellationToken>& token) {
+    if (!handle.valid()) {
+        return false;
+    }
+    Slot& s = slot(handle.index);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (s.generation != handle.generation) {
+        return false;
+    }
+    if (token && token->isCancelled()) {
+        // A late result from a cancelled batch must not replace one parked by the batch that replaced it
+        return false;
+    }
+    s.deliveredFor = handle;
+    s.delivered = data;
+    s.deliveredToken = token;
+    if (!s.queued) {
+        // Push the slot on the delivered stack; collectWeather() takes the whole stack at once, so
+        // a slot is never popped on its own and the stack cannot suffer ABA
+        s.queued = true;
+        uint32_t top = deliveredHead.load(std::memory_order_relaxed);
+        do {
+            s.nextDelivered = top;
+        } while (!deliveredHead.compare_exchange_weak(top, handle.index, std::memory_order_release, std::memory_order_relaxed));
+    }
+    return true;
+}
+
+size_t CityRegistry::collectWeather() {
+    uint32_t index = deliveredHead.exchange(none, std::memory_order_acquire);
+    size_t applied = 0;
+    while (index != none) {
+        Slot& s = slot(index);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        index = s.nextDelivered;
+        s.queued = false;
+        bool cancelled = s.deliveredToken && s.deliveredToken->isCancelled();
+        if (s.deliveredFor.generation == s.generation && !cancelled) {
+            s.city.weatherData = s.delivered;
+            if (s.delivered.cityId != 0) {
+                s.city.owmId = s.delivered.cityId; // Lets later refreshes use the group endpoint
+            }
+            applied++;
+        }
+        s.deliveredToken.reset();
+    }
+    return applied;
+}
+
+CityRegistry::Iterator CityRegistry::begin() {
+    return Iterator(this, head);
+}
+
+CityRegistry::Iterator CityRegistry::end() {
+    return Iterator(this, none);
+}
+
+CityRegistry::ConstIterator CityRegistry::begin() const {
+    return ConstIterator(this, head);
+}
+
+CityRegistry::ConstIterator CityRegistry::end() const {
+    return ConstIterator(this, none);
+}
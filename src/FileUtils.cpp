@@ -0,0 +1,119 @@
+#include "FileUtils.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifndef _WIN32
+// Function to Flush a Directory's Entries, so a file created or renamed in it survives a power loss
+bool syncDirectoryOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+}
+#endif
+
+// Function to Write `bytes` to a File, truncating it or appending, and return only once they are on disk.
+// A flush alone hands the bytes to the OS, which an OS crash or power loss can still throw away.
+bool writeDurably(const std::string& path, const std::string& bytes, bool append) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), append ? FILE_APPEND_DATA : GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        append ? OPEN_ALWAYS : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    DWORD written = 0;
+    bool ok = WriteFile(file, bytes.data(), static_cast<DWORD>(bytes.size()), &written, nullptr) != 0
+        && written == bytes.size() && FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+    return ok;
+#else
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat before;
+    bool created = ::fstat(fd, &before) == 0 && before.st_size == 0; // New (or empty) file: its entry needs a sync too
+    size_t done = 0;
+    while (done < bytes.size()) {
+        ssize_t n = ::write(fd, bytes.data() + done, bytes.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    bool ok = done == bytes.size() && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (ok && append && created) {
+        ok = syncDirectoryOf(path);
+    }
+    return ok;
+#endif
+}
+
+}
+
+bool writeFileAtomically(const std::string& path, const std::string& bytes) {
+    std::string tempPath = path + ".tmp";
+    if (!writeDurably(tempPath, bytes, false)) {
+        std::cerr << "Failed to write " << tempPath << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    bool renamed = MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    // Atomic replace on POSIX; syncing the directory makes the rename itself durable
+    bool renamed = std::rename(tempPath.c_str(), path.c_str()) == 0 && syncDirectoryOf(path);
+#endif
+    if (!renamed) {
+        std::cerr << "Failed to replace " << path << std::endl;
+        std::remove(tempPath.c_str());
+    }
+    return renamed;
+}
+
+bool appendToFileDurably(const std::string& path, const std::string& bytes) {
+    return writeDurably(path, bytes, true);
+}
+
+uint64_t fnv1a64(const char* data, size_t length, uint64_t hash) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t fileFingerprint(const std::string& path, uint64_t hash) {
+    MappedFile mapped;
+    if (!mapped.open(path)) {
+        return hash;
+    }
+    return fnv1a64(mapped.data(), mapped.size(), hash);
+}
@@ -0,0 +1,556 @@
+#include "Gazetteer.h"
+#include "FileUtils.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <set>
+
+namespace {
+
+// Header: magic, version, place count, key count, text size, checksum of everything after the header.
+// Places: name offset, name length, country, lat, lon, population, geonameId (24 bytes).
+// Keys: text offset, length, place index (12 bytes), sorted by key bytes and then by population.
+// Max tree: 2 * key count key indices (4 bytes each), a bottom-up segment tree by population.
+// K-d tree: place count nodes of x, y, z (floats) and place index (16 bytes), in implicit median order.
+// Weights: place count running totals of max(population, 1) (8 bytes each).
+const char gazetteer_magic[4] = { 'M', 'W', 'G', 'Z' };
+const size_t header_size = 32;
+const size_t place_record_size = 24;
+const size_t key_record_size = 12;
+const size_t tree_entry_size = 4;
+const size_t kd_node_size = 16;
+const size_t weight_entry_size = 8;
+const char fuzzy_alphabet[] = "abcdefghijklmnopqrstuvwxyz '-";
+
+template <typename T>
+void writeField(std::string& out, size_t offset, T value) {
+    std::memcpy(&out[offset], &value, sizeof(value));
+}
+
+template <typename T>
+T readField(const char* base, size_t offset) {
+    T value;
+    std::memcpy(&value, base + offset, sizeof(value));
+    return value;
+}
+
+struct KdPoint {
+    float xyz[3];
+    uint32_t place;
+};
+
+void toUnitVector(double lat, double lon, float xyz[3]) {
+    const double radians = 3.14159265358979323846 / 180.0;
+    xyz[0] = static_cast<float>(std::cos(lat * radians) * std::cos(lon * radians));
+    xyz[1] = static_cast<float>(std::cos(lat * radians) * std::sin(lon * radians));
+    xyz[2] = static_cast<float>(std::sin(lat * radians));
+}
+
+// Order points so the middle of every range is its median on axis depth % 3, recursively
+void buildKdTree(std::vector<KdPoint>& points, size_t first, size_t last, size_t depth) {
+    if (last - first < 2) {
+        return;
+    }
+    size_t axis = depth % 3;
+    size_t middle = first + (last - first) / 2;
+    std::nth_element(points.begin() + first, points.begin() + middle, points.begin() + last,
+        [axis](const KdPoint& a, const KdPoint& b) { return a.xyz[axis] < b.xyz[axis]; });
+    buildKdTree(points, first, middle, depth + 1);
+    buildKdTree(points, middle + 1, last, depth + 1);
+}
+
+struct PendingKey {
+    std::string key;
+    uint32_t place;
+    uint32_t population;
+};
+
+}
+
+Gazetteer::Gazetteer()
+    : ready(false), pending(false), placeTable(nullptr), keyTable(nullptr), maxTree(nullptr), kdTree(nullptr), cumulativePopulation(nullptr), textArea(nullptr), places(0), keys(0), textBytes(0) {
+}
+
+std::string Gazetteer::normalize(const std::string& name) {
+    std::string key;
+    key.reserve(name.size());
+    bool pendingSpace = false;
+    for (char c : name) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (byte < 0x80 && std::isspace(byte)) {
+            pendingSpace = !key.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            key += ' ';
+            pendingSpace = false;
+        }
+        key += byte < 0x80 ? static_cast<char>(std::tolower(byte)) : c; // UTF-8 bytes are kept as they are
+    }
+    return key;
+}
+
+// Function to Build an Index File from parsed GeoNames rows
+bool Gazetteer::write(const std::string& path, const std::vector<Source>& sources) {
+    std::vector<PendingKey> pendingKeys;
+    size_t textSize = 0;
+    for (size_t i = 0; i < sources.size(); i++) {
+        std::set<std::string> names; // A place's name often repeats among its alternates
+        names.insert(normalize(sources[i].place.name));
+        for (const auto& alternate : sources[i].alternateNames) {
+            names.insert(normalize(alternate));
+        }
+        names.erase(std::string());
+        for (const auto& key : names) {
+            PendingKey pending = { key, static_cast<uint32_t>(i), sources[i].place.population };
+            pendingKeys.push_back(pending);
+            textSize += key.size();
+        }
+        textSize += sources[i].place.name.size();
+    }
+    std::sort(pendingKeys.begin(), pendingKeys.end(), [](const PendingKey& a, const PendingKey& b) {
+        if (a.key != b.key) {
+            return a.key < b.key;
+        }
+        return a.population != b.population ? a.population > b.population : a.place < b.place;
+        });
+
+    size_t placeBytes = sources.size() * place_record_size;
+    size_t keyBytes = pendingKeys.size() * key_record_size;
+    size_t treeBytes = pendingKeys.size() * 2 * tree_entry_size;
+    size_t spatialBytes = sources.size() * (kd_node_size + weight_entry_size);
+    size_t tableBytes = placeBytes + keyBytes + treeBytes + spatialBytes;
+    std::string out(header_size + tableBytes + textSize, '\0');
+    size_t text = 0;
+    char* textStart = &out[header_size + tableBytes];
+    for (size_t i = 0; i < sources.size(); i++) {
+        const Place& place = sources[i].place;
+        size_t record = header_size + i * place_record_size;
+        size_t nameLength = std::min<size_t>(place.name.size(), 0xFFFF);
+        writeField(out, record, static_cast<uint32_t>(text));
+        writeField(out, record + 4, static_cast<uint16_t>(nameLength));
+        out[record + 6] = place.country.size() > 0 ? place.country[0] : ' ';
+        out[record + 7] = place.country.size() > 1 ? place.country[1] : ' ';
+        writeField(out, record + 8, static_cast<float>(place.lat));
+        writeField(out, record + 12, static_cast<float>(place.lon));
+        writeField(out, record + 16, place.population);
+        writeField(out, record + 20, place.geonameId);
+        std::memcpy(textStart + text, place.name.data(), nameLength);
+        text += nameLength;
+    }
+    for (size_t i = 0; i < pendingKeys.size(); i++) {
+        size_t record = header_size + placeBytes + i * key_record_size;
+        size_t keyLength = std::min<size_t>(pendingKeys[i].key.size(), 0xFFFF);
+        writeField(out, record, static_cast<uint32_t>(text));
+        writeField(out, record + 4, static_cast<uint32_t>(keyLength));
+        writeField(out, record + 8, pendingKeys[i].place);
+        std::memcpy(textStart + text, pendingKeys[i].key.data(), keyLength);
+        text += keyLength;
+    }
+    // Ties go to the lower key so suggestions come out in a stable order
+    std::vector<uint32_t> tree(pendingKeys.size() * 2, 0);
+    size_t n = pendingKeys.size();
+    for (size_t i = 0; i < n; i++) {
+        tree[n + i] = static_cast<uint32_t>(i);
+    }
+    for (size_t i = n - 1; i >= 1 && i < n; i--) {
+        uint32_t left = tree[2 * i];
+        uint32_t right = tree[2 * i + 1];
+        bool rightWins = pendingKeys[right].population > pendingKeys[left].population
+            || (pendingKeys[right].population == pendingKeys[left].population && right < left);
+        tree[i] = rightWins ? right : left;
+    }
+    for (size_t i = 0; i < tree.size(); i++) {
+        writeField(out, header_size + placeBytes + keyBytes + i * tree_entry_size, tree[i]);
+    }
+
+    std::vector<KdPoint> points(sources.size());
+    for (size_t i = 0; i < sources.size(); i++) {
+        toUnitVector(sources[i].place.lat, sources[i].place.lon, points[i].xyz);
+        points[i].place = static_cast<uint32_t>(i);
+    }
+    buildKdTree(points, 0, points.size(), 0);
+    size_t kdStart = header_size + placeBytes + keyBytes + treeBytes;
+    size_t weightStart = kdStart + sources.size() * kd_node_size;
+    uint64_t total = 0;
+    for (size_t i = 0; i < sources.size(); i++) {
+        for (size_t axis = 0; axis < 3; axis++) {
+            writeField(out, kdStart + i * kd_node_size + axis * 4, points[i].xyz[axis]);
+        }
+        writeField(out, kdStart + i * kd_node_size + 12, points[i].place);
+        total += std::max<uint32_t>(sources[i].place.population, 1); // Unknown population still gets a chance
+        writeField(out, weightStart + i * weight_entry_size, total);
+    }
+    out.resize(header_size + tableBytes + text);
+
+    std::memcpy(&out[0], gazetteer_magic, sizeof(gazetteer_magic));
+    writeField(out, 4, version);
+    writeField(out, 8, static_cast<uint32_t>(sources.size()));
+    writeField(out, 12, static_cast<uint32_t>(pendingKeys.size()));
+    writeField(out, 16, static_cast<uint64_t>(text));
+    writeField(out, 24, fnv1a64(out.data() + header_size, out.size() - header_size));
+    return writeFileAtomically(path, out);
+}
+
+bool Gazetteer::open(const std::string& path) {
+    bool opened = openIndex(path);
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending = false;
+    openFinished.notify_all();
+    return opened;
+}
+
+void Gazetteer::openPending() {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending = true;
+}
+
+bool Gazetteer::waitForOpen() const {
+    std::unique_lock<std::mutex> lock(pendingMutex);
+    openFinished.wait(lock, [this]() { return !pending; });
+    return isOpen();
+}
+
+// Function to Open an Index: the checksum and every offset are checked once here, so lookups can trust them
+bool Gazetteer::openIndex(const std::string& path) {
+    close();
+    if (!file.open(path) || file.size() < header_size
+        || std::memcmp(file.data(), gazetteer_magic, sizeof(gazetteer_magic)) != 0) {
+        close();
+        return false;
+    }
+    const char* base = file.data();
+    uint64_t placeCount = readField<uint32_t>(base, 8);
+    uint64_t keyCountInFile = readField<uint32_t>(base, 12);
+    uint64_t textSize = readField<uint64_t>(base, 16);
+    uint64_t tableBytes = placeCount * (place_record_size + kd_node_size + weight_entry_size)
+        + keyCountInFile * (key_record_size + 2 * tree_entry_size);
+    if (readField<uint32_t>(base, 4) != version || header_size + tableBytes + textSize != file.size()
+        || fnv1a64(base + header_size, file.size() - header_size) != readField<uint64_t>(base, 24)) {
+        close();
+        return false;
+    }
+    placeTable = base + header_size;
+    keyTable = placeTable + placeCount * place_record_size;
+    maxTree = keyTable + keyCountInFile * key_record_size;
+    kdTree = maxTree + keyCountInFile * 2 * tree_entry_size;
+    cumulativePopulation = kdTree + placeCount * kd_node_size;
+    textArea = cumulativePopulation + placeCount * weight_entry_size;
+    textBytes = static_cast<size_t>(textSize);
+    for (uint64_t i = 0; i < placeCount; i++) {
+        const char* record = placeTable + i * place_record_size;
+        if (static_cast<uint64_t>(readField<uint32_t>(record, 0)) + readField<uint16_t>(record, 4) > textSize) {
+            close();
+            return false;
+        }
+    }
+    for (uint64_t i = 0; i < keyCountInFile; i++) {
+        const char* record = keyTable + i * key_record_size;
+        if (static_cast<uint64_t>(readField<uint32_t>(record, 0)) + readField<uint32_t>(record, 4) > textSize
+            || readField<uint32_t>(record, 8) >= placeCount) {
+            close();
+            return false;
+        }
+    }
+    for (uint64_t i = 0; i < 2 * keyCountInFile; i++) {
+        if (readField<uint32_t>(maxTree, i * tree_entry_size) >= keyCountInFile) {
+            close();
+            return false;
+        }
+    }
+    for (uint64_t i = 0; i < placeCount; i++) {
+        if (readField<uint32_t>(kdTree, i * kd_node_size + 12) >= placeCount) {
+            close();
+            return false;
+        }
+    }
+    places = static_cast<size_t>(placeCount);
+    keys = static_cast<size_t>(keyCountInFile);
+    ready = true;
+    return true;
+}
+
+void Gazetteer::close() {
+    ready = false;
+    file.close();
+    placeTable = keyTable = maxTree = kdTree = cumulativePopulation = textArea = nullptr;
+    places = keys = textBytes = 0;
+}
+
+const char* Gazetteer::keyData(size_t key, size_t& length) const {
+    const char* record = keyTable + key * key_record_size;
+    length = readField<uint32_t>(record, 4);
+    return textArea + readField<uint32_t>(record, 0);
+}
+
+uint32_t Gazetteer::keyPlace(size_t key) const {
+    return readField<uint32_t>(keyTable + key * key_record_size, 8);
+}
+
+uint32_t Gazetteer::keyPopulation(size_t key) const {
+    return readField<uint32_t>(placeTable + static_cast<size_t>(keyPlace(key)) * place_record_size, 16);
+}
+
+Gazetteer::Place Gazetteer::placeAt(uint32_t index) const {
+    const char* record = placeTable + static_cast<size_t>(index) * place_record_size;
+    Place place;
+    place.name.assign(textArea + readField<uint32_t>(record, 0), readField<uint16_t>(record, 4));
+    place.country.assign(record + 6, 2);
+    place.lat = readField<float>(record, 8);
+    place.lon = readField<float>(record, 12);
+    place.population = readField<uint32_t>(record, 16);
+    place.geonameId = readField<uint32_t>(record, 20);
+    return place;
+}
+
+size_t Gazetteer::lowerBound(const std::string& prefix) const {
+    size_t low = 0;
+    size_t high = keys;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        size_t length;
+        const char* key = keyData(mid, length);
+        // Byte-wise compare, as std::string's operator< sorted them in write()
+        int order = std::memcmp(key, prefix.data(), std::min(length, prefix.size()));
+        if (order < 0 || (order == 0 && length < prefix.size())) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+bool Gazetteer::find(const std::string& name, Place& place) const {
+    if (!isOpen()) {
+        return false;
+    }
+    std::string key = normalize(name);
+    size_t index = lowerBound(key);
+    if (index == keys) {
+        return false;
+    }
+    size_t length;
+    const char* found = keyData(index, length);
+    if (length != key.size() || std::memcmp(found, key.data(), length) != 0) {
+        return false;
+    }
+    place = placeAt(keyPlace(index)); // Equal keys are ordered by population, so this is the largest
+    return true;
+}
+
+size_t Gazetteer::prefixEnd(const std::string& prefix) const {
+    size_t low = 0;
+    size_t high = keys;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        size_t length;
+        const char* key = keyData(mid, length);
+        // Keys whose first prefix.size() bytes sort at or before the prefix come first
+        if (std::memcmp(key, prefix.data(), std::min(length, prefix.size())) <= 0) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+size_t Gazetteer::rangeMax(size_t first, size_t last) const {
+    size_t best = keys;
+    auto consider = [&](size_t node) {
+        size_t key = readField<uint32_t>(maxTree, node * tree_entry_size);
+        if (best == keys || keyPopulation(key) > keyPopulation(best)
+            || (keyPopulation(key) == keyPopulation(best) && key < best)) {
+            best = key;
+        }
+        };
+    for (first += keys, last += keys; first < last; first >>= 1, last >>= 1) {
+        if (first & 1) {
+            consider(first++);
+        }
+        if (last & 1) {
+            consider(--last);
+        }
+    }
+    return best;
+}
+
+void Gazetteer::topPlaces(size_t first, size_t last, size_t limit, std::vector<uint32_t>& found) const {
+    struct Range {
+        uint32_t population;
+        size_t best;
+        size_t first;
+        size_t last;
+        bool operator<(const Range& other) const { return population < other.population; }
+    };
+    std::priority_queue<Range> ranges;
+    auto push = [&](size_t from, size_t to) {
+        if (from < to) {
+            size_t best = rangeMax(from, to);
+            Range range = { keyPopulation(best), best, from, to };
+            ranges.push(range);
+        }
+        };
+    push(first, last);
+    // Several names of one place can share the prefix, so a few extra pops may be needed per result
+    for (size_t pops = 0; !ranges.empty() && found.size() < limit && pops < limit * 8; pops++) {
+        Range range = ranges.top();
+        ranges.pop();
+        uint32_t place = keyPlace(range.best);
+        if (std::find(found.begin(), found.end(), place) == found.end()) {
+            found.push_back(place);
+        }
+        push(range.first, range.best);
+        push(range.best + 1, range.last);
+    }
+}
+
+// Function to Suggest Places for a Partly Typed Name
+std::vector<Gazetteer::Place> Gazetteer::suggest(const std::string& prefix, size_t limit, bool* fuzzy) const {
+    std::vector<Place> suggestions;
+    if (fuzzy) {
+        *fuzzy = false;
+    }
+    std::string key = normalize(prefix);
+    if (!isOpen() || key.empty() || limit == 0) {
+        return suggestions;
+    }
+    std::vector<uint32_t> found;
+    topPlaces(lowerBound(key), prefixEnd(key), limit, found);
+
+    if (found.empty()) {
+        // One edit away: gather the best place under every variant prefix, then keep the most populous.
+        // An edit at position i keeps key[0, i), so only positions up to the longest prefix some name
+        // starts with can match, and the characters worth inserting or substituting there are the ones
+        // that follow key[0, i) in the key table; this keeps a long miss to a few dozen searches.
+        size_t matched = 0;
+        while (matched < key.size() && lowerBound(key.substr(0, matched + 1)) < prefixEnd(key.substr(0, matched + 1))) {
+            matched++;
+        }
+        std::vector<std::pair<uint32_t, uint32_t>> candidates; // Population and place
+        auto consider = [&](const std::string& variant) {
+            if (variant.empty() || variant == key) {
+                return;
+            }
+            size_t first = lowerBound(variant);
+            size_t last = prefixEnd(variant);
+            if (first < last) {
+                size_t best = rangeMax(first, last);
+                candidates.push_back(std::make_pair(keyPopulation(best), keyPlace(best)));
+            }
+            };
+        for (size_t i = 0; i <= matched; i++) {
+            std::string head = key.substr(0, i);
+            if (i < key.size()) {
+                consider(head + key.substr(i + 1));
+            }
+            if (i + 1 < key.size()) {
+                std::string swapped = key;
+                std::swap(swapped[i], swapped[i + 1]);
+                consider(swapped);
+            }
+            // Walk the distinct characters that follow `head`, one binary search per character
+            size_t last = prefixEnd(head);
+            for (size_t next = lowerBound(head); next < last; ) {
+                size_t length;
+                const char* data = keyData(next, length);
+                if (length <= i) {
+                    next++; // The key is `head` itself
+                    continue;
+                }
+                char c = data[i];
+                if (std::strchr(fuzzy_alphabet, c) != nullptr) {
+                    consider(head + c + key.substr(i));
+                    if (i < key.size()) {
+                        consider(head + c + key.substr(i + 1));
+                    }
+                }
+                next = prefixEnd(head + c);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+            });
+        for (const auto& candidate : candidates) {
+            if (found.size() == limit) {
+                break;
+            }
+            if (std::find(found.begin(), found.end(), candidate.second) == found.end()) {
+                found.push_back(candidate.second);
+            }
+        }
+        if (fuzzy && !found.empty()) {
+            *fuzzy = true;
+        }
+    }
+
+    for (uint32_t place : found) {
+        suggestions.push_back(placeAt(place));
+    }
+    return suggestions;
+}
+
+void Gazetteer::nearestIn(size_t first, size_t last, size_t depth, const float point[3], size_t& best, float& bestDistance) const {
+    if (first >= last) {
+        return;
+    }
+    size_t middle = first + (last - first) / 2;
+    const char* node = kdTree + middle * kd_node_size;
+    float node3[3] = { readField<float>(node, 0), readField<float>(node, 4), readField<float>(node, 8) };
+    // Squared chord length grows with great-circle distance, so it ranks neighbours the same way
+    float distance = 0.0f;
+    for (size_t axis = 0; axis < 3; axis++) {
+        distance += (point[axis] - node3[axis]) * (point[axis] - node3[axis]);
+    }
+    if (distance < bestDistance) {
+        bestDistance = distance;
+        best = middle;
+    }
+    float offset = point[depth % 3] - node3[depth % 3];
+    bool lowFirst = offset < 0.0f;
+    nearestIn(lowFirst ? first : middle + 1, lowFirst ? middle : last, depth + 1, point, best, bestDistance);
+    if (offset * offset < bestDistance) {
+        nearestIn(lowFirst ? middle + 1 : first, lowFirst ? last : middle, depth + 1, point, best, bestDistance);
+    }
+}
+
+// Function to Reverse Geocode Offline: nearest neighbour in the k-d tree
+bool Gazetteer::nearest(double lat, double lon, Place& place) const {
+    if (!isOpen() || places == 0) {
+        return false;
+    }
+    float point[3];
+    toUnitVector(lat, lon, point);
+    size_t best = places;
+    float bestDistance = 5.0f; // Above the largest possible squared chord (4)
+    nearestIn(0, places, 0, point, best, bestDistance);
+    place = placeAt(readField<uint32_t>(kdTree, best * kd_node_size + 12));
+    return true;
+}
+
+bool Gazetteer::samplePlace(double unit, Place& place) const {
+    if (!isOpen() || places == 0) {
+        return false;
+    }
+    uint64_t total = readField<uint64_t>(cumulativePopulation, (places - 1) * weight_entry_size);
+    uint64_t target = std::min(static_cast<uint64_t>(unit * static_cast<double>(total)), total - 1);
+    // First place whose running total passes the target
+    size_t low = 0;
+    size_t high = places - 1;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (readField<uint64_t>(cumulativePopulation, mid * weight_entry_size) <= target) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    place = placeAt(static_cast<uint32_t>(low));
+    return true;
+}
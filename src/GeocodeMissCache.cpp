@@ -0,0 +1,92 @@
+#include "GeocodeMissCache.h"
+#include "FileUtils.h"
+#include "Gazetteer.h"
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+const std::string geocode_misses_header = "# MusaWeatherApp geocode misses v1";
+
+int64_t unixNow() {
+    return static_cast<int64_t>(std::time(nullptr));
+}
+
+}
+
+GeocodeMissCache::GeocodeMissCache(std::chrono::seconds ttl) : timeToLive(ttl), dirty(false) {
+}
+
+std::string GeocodeMissCache::keyFor(const std::string& name) {
+    return Gazetteer::normalize(name);
+}
+
+bool GeocodeMissCache::expired(int64_t missedAt, int64_t now) const {
+    return now - missedAt >= timeToLive.count() || missedAt > now; // A clock set backwards expires everything
+}
+
+bool GeocodeMissCache::contains(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = misses.find(keyFor(name));
+    return it != misses.end() && !expired(it->second, unixNow());
+}
+
+void GeocodeMissCache::add(const std::string& name) {
+    std::string key = keyFor(name);
+    if (key.empty() || key.find_first_of("\t\r\n") != std::string::npos) {
+        return; // Could not be written back as one line
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    misses[key] = unixNow();
+    dirty = true;
+}
+
+// Function to Load Remembered Misses; a missing or foreign file leaves the cache empty
+bool GeocodeMissCache::load(const std::string& path) {
+    std::ifstream infile(path);
+    std::string line;
+    if (!std::getline(infile, line) || line != geocode_misses_header) {
+        return false;
+    }
+    int64_t now = unixNow();
+    std::lock_guard<std::mutex> lock(mutex);
+    misses.clear();
+    while (std::getline(infile, line)) {
+        size_t tab = line.rfind('\t');
+        if (tab == std::string::npos || tab == 0) {
+            continue;
+        }
+        int64_t missedAt = std::strtoll(line.c_str() + tab + 1, nullptr, 10);
+        if (!expired(missedAt, now)) {
+            misses[line.substr(0, tab)] = missedAt;
+        }
+    }
+    dirty = false;
+    return true;
+}
+
+bool GeocodeMissCache::save(const std::string& path) {
+    std::ostringstream out;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!dirty) {
+            return true;
+        }
+        int64_t now = unixNow();
+        out << geocode_misses_header << '\n';
+        for (const auto& miss : misses) {
+            if (!expired(miss.second, now)) {
+                out << miss.first << '\t' << miss.second << '\n';
+            }
+        }
+        dirty = false;
+    }
+    if (!writeFileAtomically(path, out.str())) {
+        std::lock_guard<std::mutex> lock(mutex);
+        dirty = true;
+        return false;
+    }
+    return true;
+}
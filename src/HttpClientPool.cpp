@@ -0,0 +1,73 @@
+#include "HttpClientPool.h"
+
+HttpClientPool::Lease::Lease(HttpClientPool* pool, std::unique_ptr<httplib::Client> client)
+    : pool(pool), client(std::move(client)) {
+}
+
+HttpClientPool::Lease::Lease(Lease&& other)
+    : pool(other.pool), client(std::move(other.client)) {
+    other.pool = nullptr;
+}
+
+HttpClientPool::Lease::~Lease() {
+    if (pool && client) {
+        pool->release(std::move(client));
+    }
+}
+
+HttpClientPool::HttpClientPool(const std::string& host, size_t maxIdle)
+    : host(host), maxIdle(maxIdle), active(0), requests(0), clientsCreated(0),
+      connectionsOpened(std::make_shared<std::atomic<size_t>>(0)) {
+}
+
+// Function to Lease a Client, reusing an idle keep-alive client when one is available
+HttpClientPool::Lease HttpClientPool::acquire() {
+    std::unique_ptr<httplib::Client> client;
+    std::string target;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        target = host;
+        requests++;
+        active++;
+        if (!idle.empty()) {
+            client = std::move(idle.back());
+            idle.pop_back();
+        }
+        else {
+            clientsCreated++;
+        }
+    }
+    if (!client) {
+        client.reset(new httplib::Client(target));
+        client->set_keep_alive(true);
+        std::shared_ptr<std::atomic<size_t>> opened = connectionsOpened;
+        client->set_socket_options([opened](socket_t) { (*opened)++; }); // Called once per new TCP connection
+    }
+    return Lease(this, std::move(client));
+}
+
+// Function to Return a Client to the Pool, dropping it if enough clients are already idle
+void HttpClientPool::release(std::unique_ptr<httplib::Client> client) {
+    std::lock_guard<std::mutex> lock(mutex);
+    active--;
+    if (idle.size() < maxIdle) {
+        idle.push_back(std::move(client));
+    }
+}
+
+void HttpClientPool::setHost(const std::string& newHost) {
+    std::lock_guard<std::mutex> lock(mutex);
+    host = newHost;
+    idle.clear();
+}
+
+HttpClientPool::Stats HttpClientPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats s;
+    s.requests = requests;
+    s.connectionsOpened = *connectionsOpened;
+    s.clientsCreated = clientsCreated;
+    s.idleClients = idle.size();
+    s.activeClients = active;
+    return s;
+}
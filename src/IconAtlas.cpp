@@ -0,0 +1,200 @@
+#include "IconAtlas.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <iostream>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#define STB_RECT_PACK_IMPLEMENTATION
+#define STBRP_STATIC
+#include "imstb_rectpack.h"
+
+namespace {
+
+const int atlas_padding = 1;      // Empty border around each icon so linear filtering never bleeds
+const int min_atlas_size = 128;
+const int max_atlas_size = 4096;
+
+struct DecodedImage {
+    int width;
+    int height;
+    std::vector<unsigned char> rgba;
+};
+
+// Function to Shrink an RGBA Image to Fit a Square Cell, keeping its aspect ratio.
+// Each target pixel averages its whole source footprint, weighting colour by alpha so
+// transparent edges do not darken.
+DecodedImage fitToCell(const unsigned char* data, int width, int height, int cellSize) {
+    double scale = std::min(1.0, static_cast<double>(cellSize) / std::max(width, height));
+    DecodedImage image;
+    image.width = std::max(1, static_cast<int>(width * scale + 0.5));
+    image.height = std::max(1, static_cast<int>(height * scale + 0.5));
+    image.rgba.resize(static_cast<size_t>(image.width) * image.height * 4);
+    for (int y = 0; y < image.height; y++) {
+        int sy0 = y * height / image.height;
+        int sy1 = std::max(sy0 + 1, (y + 1) * height / image.height);
+        for (int x = 0; x < image.width; x++) {
+            int sx0 = x * width / image.width;
+            int sx1 = std::max(sx0 + 1, (x + 1) * width / image.width);
+            double sum[4] = { 0.0, 0.0, 0.0, 0.0 };
+            for (int sy = sy0; sy < sy1; sy++) {
+                const unsigned char* row = data + (static_cast<size_t>(sy) * width + sx0) * 4;
+                for (int sx = sx0; sx < sx1; sx++, row += 4) {
+                    double alpha = row[3];
+                    sum[0] += row[0] * alpha;
+                    sum[1] += row[1] * alpha;
+                    sum[2] += row[2] * alpha;
+                    sum[3] += alpha;
+                }
+            }
+            unsigned char* out = &image.rgba[(static_cast<size_t>(y) * image.width + x) * 4];
+            double count = static_cast<double>(sy1 - sy0) * (sx1 - sx0);
+            for (int c = 0; c < 3; c++) {
+                out[c] = sum[3] > 0.0 ? static_cast<unsigned char>(sum[c] / sum[3] + 0.5) : 0;
+            }
+            out[3] = static_cast<unsigned char>(sum[3] / count + 0.5);
+        }
+    }
+    return image;
+}
+
+}
+
+IconAtlas::IconAtlas() : pendingReady(false), built(false), textureId(0) {
+    current.width = current.height = pending.width = pending.height = 0;
+}
+
+// Function to Decode and Pack the Icon Set (any thread); the result waits in `pending` for upload()
+bool IconAtlas::build(const std::vector<Source>& sources, int cellSize) {
+    // Decode each file once, however many keys fall back to it
+    std::vector<DecodedImage> images;
+    std::map<std::string, int> imageForFile;
+    std::map<std::string, int> imageForKey;
+    for (const auto& source : sources) {
+        for (const auto& file : source.files) {
+            auto known = imageForFile.find(file);
+            if (known == imageForFile.end()) {
+                int width, height, channels;
+                unsigned char* data = stbi_load(file.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+                int index = -1;
+                if (data) {
+                    index = static_cast<int>(images.size());
+                    images.push_back(fitToCell(data, width, height, cellSize));
+                    stbi_image_free(data);
+                }
+                known = imageForFile.insert(std::make_pair(file, index)).first;
+            }
+            if (known->second >= 0) {
+                imageForKey[source.key] = known->second;
+                break;
+            }
+        }
+        if (imageForKey.find(source.key) == imageForKey.end()) {
+            std::cerr << "No icon image for " << source.key << std::endl;
+        }
+    }
+    if (images.empty()) {
+        return false;
+    }
+
+    // Pack into the smallest power-of-two square that holds every image
+    std::vector<stbrp_rect> rects(images.size());
+    int size = min_atlas_size;
+    while (true) {
+        for (size_t i = 0; i < images.size(); i++) {
+            rects[i].id = static_cast<int>(i);
+            rects[i].w = images[i].width + 2 * atlas_padding;
+            rects[i].h = images[i].height + 2 * atlas_padding;
+            rects[i].was_packed = 0;
+        }
+        std::vector<stbrp_node> nodes(size);
+        stbrp_context context;
+        stbrp_init_target(&context, size, size, nodes.data(), static_cast<int>(nodes.size()));
+        if (stbrp_pack_rects(&context, rects.data(), static_cast<int>(rects.size()))) {
+            break;
+        }
+        if (size >= max_atlas_size) {
+            std::cerr << "Weather icons do not fit in a " << max_atlas_size << " pixel atlas" << std::endl;
+            return false;
+        }
+        size *= 2;
+    }
+
+    Packed packed;
+    packed.width = size;
+    packed.height = size;
+    std::vector<unsigned char>& pixels = packed.pixels;
+    pixels.assign(static_cast<size_t>(size) * size * 4, 0);
+    std::vector<Icon> placed(images.size());
+    for (const auto& rect : rects) {
+        const DecodedImage& image = images[rect.id];
+        int left = rect.x + atlas_padding;
+        int top = rect.y + atlas_padding;
+        for (int y = 0; y < image.height; y++) {
+            std::copy(image.rgba.begin() + static_cast<size_t>(y) * image.width * 4,
+                image.rgba.begin() + static_cast<size_t>(y + 1) * image.width * 4,
+                pixels.begin() + (static_cast<size_t>(top + y) * size + left) * 4);
+        }
+        Icon icon = {
+            static_cast<float>(left) / size, static_cast<float>(top) / size,
+            static_cast<float>(left + image.width) / size, static_cast<float>(top + image.height) / size
+        };
+        placed[rect.id] = icon;
+    }
+    for (const auto& entry : imageForKey) {
+        packed.icons[entry.first] = placed[entry.second];
+    }
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    std::swap(pending, packed);
+    pendingReady = true;
+    return true;
+}
+
+// Function to Create the Atlas Texture (UI thread)
+bool IconAtlas::upload() {
+    if (pendingReady) {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        std::swap(current, pending);
+        std::vector<unsigned char>().swap(pending.pixels);
+        pending.icons.clear();
+        pendingReady = false;
+        built = true;
+        release(); // A rebuild (e.g. the next --startup-benchmark run) replaces the texture
+    }
+    if (textureId != 0) {
+        return true;
+    }
+    if (!built || current.pixels.empty()) {
+        return false;
+    }
+    GLuint id;
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, current.width, current.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, current.pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    std::vector<unsigned char>().swap(current.pixels);
+    textureId = id;
+    return true;
+}
+
+void IconAtlas::release() {
+    if (textureId != 0) {
+        GLuint id = textureId;
+        glDeleteTextures(1, &id);
+        textureId = 0;
+    }
+}
+
+bool IconAtlas::find(const std::string& key, Icon& icon) const {
+    if (!built) {
+        return false;
+    }
+    auto found = current.icons.find(key);
+    if (found == current.icons.end()) {
+        return false;
+    }
+    icon = found->second;
+    return true;
+}
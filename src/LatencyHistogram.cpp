@@ -0,0 +1,58 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double bucket_growth = 1.1;
+const size_t bucket_count = 128; // 1.1^127 ms is about three minutes
+
+}
+
+LatencyHistogram::LatencyHistogram() : buckets(bucket_count, 0), samples(0) {
+}
+
+size_t LatencyHistogram::bucketFor(double ms) {
+    if (ms <= 1.0) {
+        return 0;
+    }
+    size_t bucket = static_cast<size_t>(std::ceil(std::log(ms) / std::log(bucket_growth)));
+    return bucket < bucket_count ? bucket : bucket_count - 1;
+}
+
+double LatencyHistogram::bucketUpperBound(size_t bucket) {
+    return std::pow(bucket_growth, static_cast<double>(bucket));
+}
+
+void LatencyHistogram::record(std::chrono::milliseconds latency) {
+    std::lock_guard<std::mutex> lock(mutex);
+    buckets[bucketFor(static_cast<double>(latency.count()))]++;
+    samples++;
+}
+
+std::chrono::milliseconds LatencyHistogram::percentile(double p) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (samples == 0) {
+        return std::chrono::milliseconds(0);
+    }
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * samples));
+    size_t seen = 0;
+    for (size_t bucket = 0; bucket < bucket_count; bucket++) {
+        seen += buckets[bucket];
+        if (seen >= rank && seen > 0) {
+            return std::chrono::milliseconds(static_cast<long long>(std::ceil(bucketUpperBound(bucket))));
+        }
+    }
+    return std::chrono::milliseconds(static_cast<long long>(bucketUpperBound(bucket_count - 1)));
+}
+
+size_t LatencyHistogram::count() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return samples;
+}
+
+void LatencyHistogram::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fill(buckets.begin(), buckets.end(), 0);
+    samples = 0;
+}
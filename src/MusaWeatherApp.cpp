@@ -1,50 +1,108 @@
 #include "MusaWeatherApp.h"
+#include "AppSnapshot.h"
+#include "FileUtils.h"
+#include <cstdio>
+#include <sstream>
 
 // Constants: These define constant values used throughout the program.
 const std::string base_url = "http://api.openweathermap.org/data/2.5/weather";
+const std::string api_host = "http://api.openweathermap.org";
 const std::string favorites_file = "favorites.txt";
+const std::string weather_store_file = "weather_cache.bin";
+const std::string app_state_file = "app_state.bin";
+const std::string gazetteer_file = "assets/gazetteer.bin"; // Built by tools/gazetteer_import; optional
+const std::string startup_profile_file = "startup_profile.json"; // Phase timings of the last start
+const std::string startup_benchmark_file = "startup_benchmark.json"; // Written by --startup-benchmark
+const int default_startup_benchmark_runs = 20;
+const int app_state_save_interval_seconds = 300; // Snapshot taken this often while running, and on exit
+const std::string favorites_header = "# MusaWeatherApp favorites v";
+const int favorites_version = 2; // name<TAB>lat<TAB>lon<TAB>owmId per line
+const std::string favorites_journal_file = "favorites.journal";
+const std::string geocode_miss_file = "geocode_misses.txt"; // Names the geocoding API did not know, next to favorites.txt
+const int geocode_miss_ttl_hours = 24; // Retried after a day in case the name was added upstream
+const std::string favorites_journal_header = "# MusaWeatherApp favorites journal v1";
+const size_t favorites_journal_min_compact = 1024; // Records the journal may always hold before compaction
+size_t favoritesJournalRecords = 0; // Records in the journal since the last compaction
 std::string api_key;
+const size_t max_fetch_workers = 8; // Upper bound on concurrent weather requests
+const size_t max_geocode_workers = 4; // Concurrent lookups when resolving favorites saved by name only
+const size_t max_lookup_workers = 2;  // Concurrent Add Place and Add Random City lookups
+const double random_city_jitter_degrees = 0.5; // About 50 km around the sampled place
+const size_t max_place_suggestions = 8; // Typeahead rows under the Add Place input
+const std::string weather_icon_dir = "assets/icons/"; // Optional full OpenWeatherMap set, e.g. 10n.png
+const int weather_icon_size = 128; // Icons are shrunk to fit this many pixels in the atlas
+const size_t max_group_size = 20;   // Most city ids the /data/2.5/group endpoint accepts per call
+const int weather_cache_ttl_seconds = 600; // OpenWeatherMap refreshes current weather about every 10 minutes
+const size_t weather_cache_capacity = 20000;  // Locations kept in memory (about 4 MB)
+const size_t weather_store_capacity = 4096;   // Locations kept on disk (4 MB of slots)
+const int weather_store_max_age_hours = 72;   // Older persisted data is not worth showing
+const double api_calls_per_minute = 60.0;     // Free-tier budget of the API key
+const double api_call_burst = 10.0;           // Calls that may go out back to back before the rate applies
 
 // Initial List of Cities
-std::vector<City> cities = {
-    {"New York", -74.0060, 40.7128, false, nullptr},
-    {"Los Angeles", -118.2437, 34.0522, false, nullptr},
-    {"London", -0.1276, 51.5074, false, nullptr},
-    {"Paris", 2.3522, 48.8566, false, nullptr},
-    {"Tokyo", 139.6917, 35.6895, false, nullptr},
-    {"Shanghai", 121.4737, 31.2304, false, nullptr},
-    {"Moscow", 37.6173, 55.7558, false, nullptr},
-    {"Mumbai", 72.8777, 19.0760, false, nullptr},
-    {"Rio de Janeiro", -43.1729, -22.9068, false, nullptr},
-    {"Sydney", 151.2093, -33.8688, false, nullptr},
-    {"Cairo", 31.2357, 30.0444, false, nullptr},
-    {"Buenos Aires", -58.3816, -34.6037, false, nullptr},
-    {"Toronto", -79.3832, 43.6532, false, nullptr},
-    {"Mexico City", -99.1332, 19.4326, false, nullptr},
-    {"Dubai", 55.2708, 25.2048, false, nullptr},
-    {"Johannesburg", 28.0473, -26.2041, false, nullptr},
-    {"Singapore", 103.8198, 1.3521, false, nullptr},
-    {"Hong Kong", 114.1694, 22.3193, false, nullptr},
-    {"Berlin", 13.4050, 52.5200, false, nullptr},
-    {"Rome", 12.4964, 41.9028, false, nullptr},
-    {"Seoul", 126.9780, 37.5665, false, nullptr},
-    {"Bangkok", 100.5018, 13.7563, false, nullptr},
-    {"Istanbul", 28.9784, 41.0082, false, nullptr},
-    {"Lagos", 3.3792, 6.5244, false, nullptr},
-    {"Jakarta", 106.8456, -6.2088, false, nullptr},
-    {"Madrid", -3.7038, 40.4168, false, nullptr},
-    {"Beijing", 116.4074, 39.9042, false, nullptr},
-    {"Sao Paulo", -46.6333, -23.5505, false, nullptr},
-    {"Chicago", -87.6298, 41.8781, false, nullptr},
-    {"San Francisco", -122.4194, 37.7749, false, nullptr},
-    {"Buenos Aires", -58.3816, -34.6037, false, nullptr}
+CityRegistry cities = {
+    {"New York", -74.0060, 40.7128, false},
+    {"Los Angeles", -118.2437, 34.0522, false},
+    {"London", -0.1276, 51.5074, false},
+    {"Paris", 2.3522, 48.8566, false},
+    {"Tokyo", 139.6917, 35.6895, false},
+    {"Shanghai", 121.4737, 31.2304, false},
+    {"Moscow", 37.6173, 55.7558, false},
+    {"Mumbai", 72.8777, 19.0760, false},
+    {"Rio de Janeiro", -43.1729, -22.9068, false},
+    {"Sydney", 151.2093, -33.8688, false},
+    {"Cairo", 31.2357, 30.0444, false},
+    {"Buenos Aires", -58.3816, -34.6037, false},
+    {"Toronto", -79.3832, 43.6532, false},
+    {"Mexico City", -99.1332, 19.4326, false},
+    {"Dubai", 55.2708, 25.2048, false},
+    {"Johannesburg", 28.0473, -26.2041, false},
+    {"Singapore", 103.8198, 1.3521, false},
+    {"Hong Kong", 114.1694, 22.3193, false},
+    {"Berlin", 13.4050, 52.5200, false},
+    {"Rome", 12.4964, 41.9028, false},
+    {"Seoul", 126.9780, 37.5665, false},
+    {"Bangkok", 100.5018, 13.7563, false},
+    {"Istanbul", 28.9784, 41.0082, false},
+    {"Lagos", 3.3792, 6.5244, false},
+    {"Jakarta", 106.8456, -6.2088, false},
+    {"Madrid", -3.7038, 40.4168, false},
+    {"Beijing", 116.4074, 39.9042, false},
+    {"Sao Paulo", -46.6333, -23.5505, false},
+    {"Chicago", -87.6298, 41.8781, false},
+    {"San Francisco", -122.4194, 37.7749, false},
+    {"Buenos Aires", -58.3816, -34.6037, false}
 };
 
 
 
 // Global Variables for Threading
-std::mutex weatherDataMutex;
-std::atomic<int> threadsFinished(0);
+SingleFlight<WeatherReply> weatherFlights; // Coalesces identical weather requests that overlap in time
+WeatherCache weatherCache{ std::chrono::seconds(weather_cache_ttl_seconds), weather_cache_capacity };
+Gazetteer gazetteer; // Offline place names, consulted before the geocoding API
+GeocodeMissCache geocodeMisses{ std::chrono::hours(geocode_miss_ttl_hours) }; // Unknown names answered without a call
+IconAtlas iconAtlas; // Every weather icon in one texture, decoded off the UI thread
+WeatherStore weatherStore(weather_store_file, weather_store_capacity, std::chrono::hours(weather_store_max_age_hours));
+HttpClientPool apiClientPool(api_host, max_fetch_workers + 2); // One keep-alive connection per worker, plus the UI thread
+RateLimiter apiRateLimiter(api_calls_per_minute, api_call_burst, max_fetch_workers);
+const RequestPolicy default_request_policy = {
+    std::chrono::milliseconds(10000), 3, std::chrono::milliseconds(250), std::chrono::milliseconds(2000), true
+};
+const std::chrono::milliseconds max_connect_time(3000);
+LatencyHistogram apiLatency;     // Per-attempt latency of answered requests; its p95 sets the hedge delay
+RequestStats apiRequestStats{};
+// The pools come last: globals are destroyed in reverse order, so each pool waits for its running jobs
+// while everything those jobs use still exists. Fetch jobs submit hedges, so hedgePool outlives fetchPool,
+// and cancelPool outlives them all so the cancels queued on exit still close the sockets they wait on.
+WorkerPool cancelPool(1); // Runs cancel callbacks (closing sockets) for the UI thread, one token after another
+// A hedge job waits on its primary inside a worker, so there is one worker for every thread that can send a
+// primary (the fetch, lookup and geocoding pools); fewer, and under a full batch hedges queue behind other
+// hedges' waits and fire late or not at all
+WorkerPool hedgePool(max_fetch_workers + max_lookup_workers + max_geocode_workers);
+WorkerPool fetchPool(max_fetch_workers); // Shared by every "See Weather" click
+WorkerPool lookupPool(max_lookup_workers); // Geocoding for the UI, kept apart so it never queues behind a weather batch
+WorkerPool geocodePool(max_geocode_workers); // Favorites resolved in the background at startup
+WorkerPool stateWriter(1); // Writes app-state snapshots off the UI thread, one at a time
 
 // Function to Read API Key from File
 std::string readApiKeyFromFile(const std::string& filePath) {
@@ -61,96 +119,867 @@ std::string readApiKeyFromFile(const std::string& filePath) {
     return key;
 }
 
-// Function to Fetch Weather Data for a City
-void getWeatherDataForEach(City& city) {
-    httplib::Client cli("http://api.openweathermap.org");
-    std::string url = "/data/2.5/weather?lat=" + std::to_string(city.lat) + "&lon=" + std::to_string(city.lon) + "&appid=" + api_key;
+// Hedge State: Shared by a request and its hedge so whichever finishes first is used
+struct HedgeState {
+    std::mutex mutex;
+    std::condition_variable primaryFinished; // Also signalled when the primary is admitted by the rate limiter
+    bool primarySent = false;
+    bool primaryDone = false;
+    bool hedgeWon = false;
+    httplib::Client* primaryClient = nullptr;
+    httplib::Client* hedgeClient = nullptr; // Set while the hedge request is on the wire
+    httplib::Result hedgeResult;
+};
+
+// Function to Send One Attempt over a Pooled Client, bounded by the time left before the deadline.
+// Cancelling the token closes the client's socket, so an attempt stuck in connect or read returns at once.
+// With `hedge` set the attempt is that request's primary, or with `isHedge` its hedge.
+httplib::Result sendAttempt(const std::string& path, std::chrono::milliseconds timeout, HttpClientPool::Lease& client,
+    const std::shared_ptr<CancellationToken>& token, HedgeState* hedge = nullptr, bool isHedge = false) {
+    client->set_connection_timeout(std::min(timeout, max_connect_time)); // A connect cannot be interrupted, so keep it short
+    client->set_read_timeout(timeout);
+
+    if (!apiRateLimiter.acquire(token.get())) {
+        return httplib::Result(nullptr, httplib::Error::Canceled);
+    }
+    if (hedge) {
+        std::lock_guard<std::mutex> lock(hedge->mutex);
+        if (isHedge) {
+            // Stopping a client before it has a socket does nothing, so a hedge whose primary already
+            // answered must not go out at all; once recorded, the primary stops it when it answers
+            if (hedge->primaryDone) {
+                apiRateLimiter.release(0);
+                return httplib::Result(nullptr, httplib::Error::Canceled);
+            }
+            hedge->hedgeClient = &*client;
+        }
+        else {
+            hedge->primarySent = true;
+            hedge->primaryFinished.notify_all();
+        }
+    }
+    CancelRegistration stopOnCancel(token.get(), [&client]() { client->stop(); });
+    if (token && token->isCancelled()) {
+        // Cancelled before the socket was opened: stop() had nothing to close, and Get would open a new one
+        apiRateLimiter.release(0);
+        return httplib::Result(nullptr, httplib::Error::Canceled);
+    }
+    auto started = std::chrono::steady_clock::now();
+    httplib::Result res = client->Get(path.c_str());
+    apiRateLimiter.release(res ? res->status : 0);
+    apiRequestStats.attempts++;
+    if (res) {
+        apiLatency.record(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started));
+    }
+    return res;
+}
+
+// Function to Send One Attempt, hedged: if it is still running after the p95 latency a second copy goes out,
+// and the first successful answer wins (the loser's connection is closed, whichever of the two it is)
+httplib::Result sendHedgedAttempt(const std::string& path, std::chrono::milliseconds timeout,
+    const std::shared_ptr<CancellationToken>& token) {
+    HttpClientPool::Lease client = apiClientPool.acquire();
+    std::chrono::milliseconds hedgeDelay = apiLatency.percentile(95.0);
+    if (apiLatency.count() < 20 || hedgeDelay >= timeout) {
+        return sendAttempt(path, timeout, client, token); // Not enough history to know what slow means
+    }
+
+    std::shared_ptr<HedgeState> state = std::make_shared<HedgeState>();
+    state->primaryClient = &*client;
+    hedgePool.submit([state, path, hedgeDelay, timeout, token]() {
+        {
+            // The delay counts from when the primary got past the rate limiter; time spent queued there
+            // is not a slow answer, and hedging it would only queue a second copy behind it
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->primaryFinished.wait(lock, [&state]() { return state->primarySent || state->primaryDone; });
+            if (state->primaryFinished.wait_for(lock, hedgeDelay, [&state]() { return state->primaryDone; })
+                || (token && token->isCancelled())) {
+                return;
+            }
+        }
+        apiRequestStats.hedgesSent++;
+        HttpClientPool::Lease hedgeClient = apiClientPool.acquire();
+        httplib::Result res = sendAttempt(path, timeout - hedgeDelay, hedgeClient, token, state.get(), true);
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->hedgeClient = nullptr; // The lease goes back to the pool when this job returns
+        if (!state->primaryDone && res && res->status == 200) {
+            state->hedgeWon = true;
+            state->hedgeResult = std::move(res);
+            state->primaryClient->stop(); // Unblocks the primary's socket read
+        }
+        });
+
+    httplib::Result res = sendAttempt(path, timeout, client, token, state.get());
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->primaryDone = true;
+    state->primaryFinished.notify_all();
+    if (state->hedgeClient) {
+        apiRequestStats.hedgesStopped++;
+        state->hedgeClient->stop(); // The primary answered first; free the hedge's worker and rate-limiter slot
+    }
+    if (state->hedgeWon) {
+        apiRequestStats.hedgesWon++;
+        return std::move(state->hedgeResult);
+    }
+    return res;
+}
+
+// Function to Send a GET Request to the OpenWeatherMap API over a pooled keep-alive connection.
+// Every attempt passes through apiRateLimiter; failed attempts are retried with jittered exponential
+// backoff until the policy's retries or deadline run out, or until `token` is cancelled.
+httplib::Result apiGet(const std::string& path, const RequestPolicy& policy, const std::shared_ptr<CancellationToken>& token) {
+    static thread_local std::mt19937 rng(std::random_device{}());
+    auto started = std::chrono::steady_clock::now();
+    httplib::Result res;
+    for (int attempt = 0; ; attempt++) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+        std::chrono::milliseconds remaining = policy.deadline - elapsed;
+        if (remaining.count() <= 0) {
+            apiRequestStats.deadlinesExceeded++;
+            return res;
+        }
+
+        if (policy.hedge) {
+            res = sendHedgedAttempt(path, remaining, token);
+        }
+        else {
+            HttpClientPool::Lease client = apiClientPool.acquire();
+            res = sendAttempt(path, remaining, client, token);
+        }
+        if (token && token->isCancelled()) {
+            return httplib::Result(nullptr, httplib::Error::Canceled);
+        }
+        bool retryable = !res || res->status == 429 || res->status >= 500;
+        if (!retryable || attempt >= policy.maxRetries) {
+            return res;
+        }
+
+        // Full jitter: wait a random time up to the exponential backoff so retries from a batch spread out
+        long long cap = std::min<long long>(policy.maxBackoff.count(), policy.baseBackoff.count() << attempt);
+        std::chrono::milliseconds backoff(std::uniform_int_distribution<long long>(0, cap)(rng));
+        elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started); // The attempt took time too
+        if (elapsed + backoff >= policy.deadline) {
+            apiRequestStats.deadlinesExceeded++;
+            return res;
+        }
+        apiRequestStats.retries++;
+        if (token ? token->waitFor(backoff) : (std::this_thread::sleep_for(backoff), false)) {
+            return httplib::Result(nullptr, httplib::Error::Canceled);
+        }
+    }
+}
+
+// Function to Build the Key Shared by Requests for the Same Location (0.01 degree grid, about 1 km)
+std::string locationKey(double lat, double lon) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.2f,%.2f", lat, lon);
+    return std::string(buffer);
+}
+
+// Function to Record a Fresh Response in the Weather Cache and its On-Disk Copy
+void rememberWeather(const std::string& key, const WeatherSnapshot& data) {
+    weatherCache.put(key, data);
+    weatherStore.save(key, data.encode(), static_cast<int64_t>(std::time(nullptr)));
+}
 
-    auto res = cli.Get(url.c_str());
+// Function to Decode Restored Weather into the Cache (lookup pool); newer data already cached wins
+void decodeRestoredWeather(const std::vector<WeatherStore::Record>& records) {
+    int64_t now = static_cast<int64_t>(std::time(nullptr));
+    for (const auto& record : records) {
+        std::chrono::seconds age(std::max<int64_t>(0, now - record.fetchedAt));
+        WeatherSnapshot cached;
+        std::chrono::seconds cachedAge;
+        if (weatherCache.peek(record.key, cached, cachedAge) && cachedAge <= age) {
+            continue;
+        }
+        WeatherSnapshot data;
+        if (WeatherSnapshot::decode(record.body, data)) {
+            weatherCache.put(record.key, data, age);
+        }
+    }
+}
+
+// Function to Decode Restored Weather into the Cache on the Lookup Pool
+void restoreWeather(std::vector<WeatherStore::Record> records) {
+    std::shared_ptr<std::vector<WeatherStore::Record>> pending = std::make_shared<std::vector<WeatherStore::Record>>();
+    pending->swap(records);
+    lookupPool.submit([pending]() { decodeRestoredWeather(*pending); });
+}
+
+// Function to Restore Last-Known Weather from Disk so it is available before any request completes.
+// The store is mapped and indexed right away (it must be before the first save); parsing happens in the background.
+void loadPersistedWeather() {
+    restoreWeather(weatherStore.load());
+}
+
+// Function to Request Weather Data by Coordinates, parsed into a snapshot on the calling worker
+WeatherReply fetchWeatherAt(double lat, double lon, const std::shared_ptr<CancellationToken>& token) {
+    std::string url = "/data/2.5/weather?lat=" + std::to_string(lat) + "&lon=" + std::to_string(lon) + "&appid=" + api_key;
+
+    WeatherReply reply = { WeatherReply::Failed, std::vector<WeatherSnapshot>() };
+    auto res = apiGet(url, default_request_policy, token);
     if (res && res->status == 200) {
-        std::lock_guard<std::mutex> lock(weatherDataMutex);
-        city.weatherData = nlohmann::json::parse(res->body);
+        WeatherSnapshot snapshot;
+        if (WeatherSnapshot::parse(res->body, snapshot)) {
+            reply.status = WeatherReply::Ok;
+            reply.snapshots.push_back(snapshot);
+            return reply;
+        }
     }
-    else {
-        std::cerr << "Failed to fetch weather data for " << city.name << std::endl;
+    if (token && token->isCancelled()) {
+        reply.status = WeatherReply::Cancelled;
+    }
+    return reply;
+}
+
+// Function to Share One Request per Key among Concurrent Callers. If the caller that sent it was cancelled,
+// callers that are still live send their own.
+WeatherReply runWeatherFlight(const std::string& key, const std::shared_ptr<CancellationToken>& token,
+    const std::function<WeatherReply()>& fetch) {
+    WeatherReply reply = weatherFlights.run(key, fetch);
+    while (reply.status == WeatherReply::Cancelled && !(token && token->isCancelled())) {
+        reply = weatherFlights.run(key, fetch);
+    }
+    return reply;
+}
+
+// Function to Fetch Weather Data for a City (runs as a fetchPool job); the result is dropped if the
+// token is cancelled before the UI thread collects it
+void getWeatherDataForEach(const WeatherTarget& target, const std::shared_ptr<CancellationToken>& token) {
+    double lat = target.lat;
+    double lon = target.lon;
+    // Duplicate requests for the same location that are already in flight wait for that response
+    WeatherReply reply = runWeatherFlight(locationKey(lat, lon), token, [lat, lon, token]() { return fetchWeatherAt(lat, lon, token); });
+    if (reply.status != WeatherReply::Ok) {
+        if (!token->isCancelled()) {
+            std::cerr << "Failed to fetch weather data for " << target.name << std::endl;
+        }
+        return;
+    }
+    const WeatherSnapshot& data = reply.snapshots.front();
+    rememberWeather(locationKey(lat, lon), data);
+    cities.deliverWeather(target.city, data, token); // Carries the city id, so later refreshes can use the group endpoint
+}
+
+// Function to Fetch Weather Data for up to max_group_size Cities with Known Ids in One Request
+void getWeatherDataForGroup(const std::vector<WeatherTarget>& group, const std::shared_ptr<CancellationToken>& token) {
+    std::set<int> uniqueIds;
+    std::string ids;
+    for (const WeatherTarget& target : group) {
+        if (uniqueIds.insert(target.owmId).second) {
+            ids += (ids.empty() ? "" : ",") + std::to_string(target.owmId);
+        }
+    }
+    WeatherReply reply = runWeatherFlight("group:" + ids, token, [ids, token]() {
+        WeatherReply result = { WeatherReply::Failed, std::vector<WeatherSnapshot>() };
+        auto res = apiGet("/data/2.5/group?id=" + ids + "&appid=" + api_key, default_request_policy, token);
+        if (res && res->status == 200) {
+            if (WeatherSnapshot::parseList(res->body, result.snapshots)) {
+                result.status = WeatherReply::Ok;
+                return result;
+            }
+        }
+        if (token->isCancelled()) {
+            result.status = WeatherReply::Cancelled;
+        }
+        return result;
+        });
+
+    if (reply.status != WeatherReply::Ok) {
+        if (!token->isCancelled()) {
+            std::cerr << "Failed to fetch weather data for a group of " << group.size() << " cities" << std::endl;
+        }
+        return;
+    }
+    std::map<int, const WeatherSnapshot*> byId;
+    for (const auto& entry : reply.snapshots) {
+        byId[entry.cityId] = &entry;
+    }
+    // Fan each entry of the list back out to every city that carries its id
+    for (const WeatherTarget& target : group) {
+        auto it = byId.find(target.owmId);
+        if (it != byId.end()) {
+            rememberWeather(locationKey(target.lat, target.lon), *it->second);
+            cities.deliverWeather(target.city, *it->second, token);
+        }
+        else if (!token->isCancelled()) {
+            std::cerr << "No weather data returned for " << target.name << std::endl;
+        }
+    }
+}
+
+// Function to Serve a City from the Weather Cache (UI thread); stale data is served too, but the city still needs a refresh
+WeatherCache::Lookup serveCachedWeather(City& city) {
+    WeatherSnapshot data;
+    WeatherCache::Lookup lookup = weatherCache.get(locationKey(city.lat, city.lon), data);
+    if (lookup != WeatherCache::Lookup::Miss) {
+        city.weatherData = data;
+        if (data.cityId != 0) {
+            city.owmId = data.cityId;
+        }
+    }
+    return lookup;
+}
+
+// Function to Plan a Weather Refresh: cities with a known id are packed into group requests,
+// the rest are fetched one by one by coordinates
+std::vector<std::vector<WeatherTarget>> planWeatherBatches(const std::vector<WeatherTarget>& targets) {
+    std::vector<std::vector<WeatherTarget>> batches;
+    std::vector<WeatherTarget> group;
+    for (const WeatherTarget& target : targets) {
+        if (target.owmId == 0) {
+            batches.push_back(std::vector<WeatherTarget>(1, target));
+            continue;
+        }
+        group.push_back(target);
+        if (group.size() == max_group_size) {
+            batches.push_back(group);
+            group.clear();
+        }
+    }
+    if (!group.empty()) {
+        batches.push_back(group);
+    }
+    return batches;
+}
+
+// Function to Key a Batch's Jobs by City Handle
+uint64_t batchCityKey(CityHandle city) {
+    return (static_cast<uint64_t>(city.index) << 32) | city.generation;
+}
+
+// Function to Queue One Planned Request on the Worker Pool as Part of a Batch, under a token of its own
+// that the batch's token cancels too
+void submitWeatherJob(const std::shared_ptr<WeatherBatch>& batch, const std::vector<WeatherTarget>& group, bool counted) {
+    bool byCoordinates = group.size() == 1 && group[0].owmId == 0;
+    if (counted) {
+        batch->queued++;
+    }
+    std::shared_ptr<CancellationToken> token = std::make_shared<CancellationToken>();
+    batch->token->onCancel([token]() { token->cancel(); });
+    WeatherBatch::Job job = { token, group.size() };
+    for (const WeatherTarget& target : group) {
+        batch->jobsByCity.insert(std::make_pair(batchCityKey(target.city), batch->jobs.size()));
+    }
+    batch->jobs.push_back(job);
+    fetchPool.submit([batch, token, group, byCoordinates, counted]() {
+        if (!token->isCancelled()) {
+            if (byCoordinates) {
+                getWeatherDataForEach(group[0], token);
+            }
+            else {
+                getWeatherDataForGroup(group, token);
+            }
+        }
+        if (counted) {
+            batch->finished++;
+        }
+        });
+}
+
+// Function to Start a Weather Batch: serve what the cache has, fetch the misses, refresh stale entries in the background
+std::shared_ptr<WeatherBatch> startWeatherBatch(const std::vector<City*>& targets) {
+    std::shared_ptr<WeatherBatch> batch = std::make_shared<WeatherBatch>();
+    std::vector<WeatherTarget> misses;
+    std::vector<WeatherTarget> staleCities;
+    for (City* city : targets) {
+        WeatherCache::Lookup lookup = serveCachedWeather(*city);
+        WeatherTarget target = { city->handle, city->name, city->lat, city->lon, city->owmId };
+        if (lookup == WeatherCache::Lookup::Miss) {
+            misses.push_back(target);
+        }
+        else if (lookup == WeatherCache::Lookup::Stale) {
+            staleCities.push_back(target);
+        }
+    }
+    // Cities with a known id share group requests, the rest are fetched individually
+    for (auto& group : planWeatherBatches(misses)) {
+        submitWeatherJob(batch, group, true);
+    }
+    // Background refreshes do not hold the batch open
+    for (auto& group : planWeatherBatches(staleCities)) {
+        submitWeatherJob(batch, group, false);
+    }
+    return batch;
+}
+
+// Function to Cancel a Batch; results of the batch that have not been collected yet are dropped
+void cancelWeatherBatch(const std::shared_ptr<WeatherBatch>& batch) {
+    if (!batch || batch->token->isCancelled()) {
+        return;
+    }
+    // Closing the sockets waits for any connect still in progress, so keep it off the UI thread
+    batch->token->cancelInBackground(cancelPool);
+}
+
+// Function to Abort a Batch's Requests for a City that is Being Removed (UI thread). A request for that
+// city alone is cancelled; a group request only once every city in it is gone. Results for the city
+// from a group that keeps running are dropped by the registry, since its handle goes stale.
+void cancelCityRequests(const std::shared_ptr<WeatherBatch>& batch, CityHandle city) {
+    if (!batch || batch->token->isCancelled()) {
+        return;
+    }
+    auto range = batch->jobsByCity.equal_range(batchCityKey(city));
+    for (auto it = range.first; it != range.second; ++it) {
+        WeatherBatch::Job& job = batch->jobs[it->second];
+        if (job.liveCities > 0 && --job.liveCities == 0) {
+            job.token->cancelInBackground(cancelPool);
+        }
     }
-    threadsFinished++;
+    batch->jobsByCity.erase(range.first, range.second);
 }
 
-// Function to Validate if a City Name is Valid
-bool validateCity(const std::string& cityName, double& lon, double& lat) {
-    httplib::Client cli("http://api.openweathermap.org");
+// Function to Validate if a City Name is Valid: the offline gazetteer first, the geocoding API on a miss.
+// Only a 200 answer with no match is NotFound; any other failure is Failed.
+LookupOutcome validateCity(const std::string& cityName, double& lon, double& lat, const std::shared_ptr<CancellationToken>& token) {
+    Gazetteer::Place place;
+    if (gazetteer.find(cityName, place)) {
+        lon = place.lon;
+        lat = place.lat;
+        return LookupOutcome::Found;
+    }
+    if (geocodeMisses.contains(cityName)) {
+        return LookupOutcome::NotFound;
+    }
+
     std::string url = "/geo/1.0/direct?q=" + cityName + "&limit=1&appid=" + api_key;
 
-    auto res = cli.Get(url.c_str());
-    if (res && res->status == 200) {
-        auto data = nlohmann::json::parse(res->body);
-        if (!data.empty()) {
-            lon = data[0]["lon"];
-            lat = data[0]["lat"];
-            return true;
+    auto res = apiGet(url, default_request_policy, token);
+    if (!res || res->status != 200) {
+        return LookupOutcome::Failed;
+    }
+    auto data = nlohmann::json::parse(res->body);
+    if (data.empty()) {
+        geocodeMisses.add(cityName); // The API answered and knows no such place; failed calls are not remembered
+        return LookupOutcome::NotFound;
+    }
+    lon = data[0]["lon"];
+    lat = data[0]["lat"];
+    return LookupOutcome::Found;
+}
+
+// Function to Look Up a City by Name on the given pool; a lookup that got no answer fails the job
+GeocodeJob startCityLookup(const std::string& cityName, WorkerPool& pool) {
+    Gazetteer::Place place;
+    if (gazetteer.find(cityName, place)) {
+        GeocodeResult local = { true, cityName, place.lon, place.lat };
+        return AsyncJob<GeocodeResult>::completed(local); // No round trip: ready in the same frame
+    }
+    if (geocodeMisses.contains(cityName)) {
+        GeocodeResult unknown = { false, cityName, 0.0, 0.0 };
+        return AsyncJob<GeocodeResult>::completed(unknown);
+    }
+    return AsyncJob<GeocodeResult>::start(pool, [cityName](const std::shared_ptr<CancellationToken>& token) {
+        GeocodeResult place = { false, cityName, 0.0, 0.0 };
+        gazetteer.waitForOpen(); // At startup the index may still be opening; asking the API instead would waste a call
+        LookupOutcome outcome = token->isCancelled() ? LookupOutcome::Failed : validateCity(cityName, place.lon, place.lat, token);
+        if (outcome == LookupOutcome::Failed) {
+            throw std::runtime_error("Lookup failed for " + cityName); // Says nothing about the place; callers keep it
         }
+        place.found = outcome == LookupOutcome::Found;
+        return place;
+        });
+}
+
+// Function to Find the City Nearest to a Coordinate: the gazetteer's k-d tree when it is open, else the API on the Lookup Pool
+GeocodeJob startReverseLookup(double lat, double lon) {
+    Gazetteer::Place nearby;
+    if (gazetteer.nearest(lat, lon, nearby)) {
+        GeocodeResult local = { true, nearby.name, nearby.lon, nearby.lat };
+        return AsyncJob<GeocodeResult>::completed(local);
+    }
+    return AsyncJob<GeocodeResult>::start(lookupPool, [lat, lon](const std::shared_ptr<CancellationToken>& token) {
+        GeocodeResult place = { false, "", 0.0, 0.0 };
+        std::string url = "/geo/1.0/reverse?lat=" + std::to_string(lat) + "&lon=" + std::to_string(lon) + "&limit=1&appid=" + api_key;
+        auto res = apiGet(url, default_request_policy, token);
+        if (!res || res->status != 200) {
+            throw std::runtime_error("Failed to fetch random city from API");
+        }
+        auto cityList = nlohmann::json::parse(res->body);
+        if (!cityList.empty()) {
+            place.found = true;
+            place.name = cityList[0]["name"];
+            place.lon = cityList[0]["lon"];
+            place.lat = cityList[0]["lat"];
+        }
+        return place;
+        });
+}
+
+// Function to Pick a Random Populated Place Offline: sample a place by population, move a random
+// distance of up to random_city_jitter_degrees away, and take the place nearest to that point, so
+// towns around big cities come up as well as the cities themselves. Never lands in the ocean.
+bool randomGazetteerPlace(std::mt19937& rng, GeocodeResult& result) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    Gazetteer::Place anchor, nearby;
+    if (!gazetteer.samplePlace(unit(rng), anchor)) {
+        return false;
+    }
+    double lat = std::max(-90.0, std::min(90.0, anchor.lat + (unit(rng) * 2.0 - 1.0) * random_city_jitter_degrees));
+    double lon = anchor.lon + (unit(rng) * 2.0 - 1.0) * random_city_jitter_degrees;
+    if (!gazetteer.nearest(lat, lon, nearby)) {
+        return false;
+    }
+    result.found = true;
+    result.name = nearby.name;
+    result.lon = nearby.lon;
+    result.lat = nearby.lat;
+    return true;
+}
+
+// Function to Add a New Place found by startCityLookup (UI thread)
+void addNewPlace(const GeocodeResult& place) {
+    if (place.found) {
+        cities.add({ place.name, place.lon, place.lat, false });
+        std::cout << "City added: " << place.name << std::endl;
+    }
+    else {
+        std::cerr << "City not found: " << place.name << std::endl;
     }
-    return false;
 }
 
-// Function to Add a New Place
-void addNewPlace(const std::string& cityName) {
-    double lon, lat;
-    if (validateCity(cityName, lon, lat)) {
-        cities.push_back({ cityName, lon, lat, false, nullptr });
-        std::cout << "City added: " << cityName << std::endl;
+// Function to Parse One Favorites Line: "name<TAB>lat<TAB>lon<TAB>owmId", or just a name when the location is unknown
+City parseFavoriteLine(const std::string& line) {
+    City place = { line, 0.0, 0.0, false };
+    std::istringstream fields(line);
+    std::string lat, lon, owmId;
+    if (std::getline(fields, place.name, '\t') && std::getline(fields, lat, '\t') && std::getline(fields, lon, '\t')) {
+        place.lat = std::atof(lat.c_str());
+        place.lon = std::atof(lon.c_str());
+        if (std::getline(fields, owmId, '\t')) {
+            place.owmId = std::atoi(owmId.c_str());
+        }
     }
     else {
-        std::cerr << "City not found: " << cityName << std::endl;
+        place.name = line;
+        place.geocodePending = true;
     }
+    return place;
+}
+
+// Function to Format One Favorites Line (the inverse of parseFavoriteLine)
+std::string formatFavoriteLine(const City& city) {
+    if (city.geocodePending) {
+        return city.name;
+    }
+    char fields[80];
+    std::snprintf(fields, sizeof(fields), "\t%.6f\t%.6f\t%d", city.lat, city.lon, city.owmId);
+    return city.name + fields;
+}
+
+// Function to Fingerprint the Saved Favorites (favorites.txt plus its journal)
+uint64_t favoritesFingerprint() {
+    return fileFingerprint(favorites_journal_file, fileFingerprint(favorites_file));
 }
 
-// Function to Load Favorite Cities from a File
-void loadMyCityList(std::vector<City>& cities, std::set<std::string>& favorites) {
+// Function to Load Favorite Cities from a File and replay the journal of changes made since it was last
+// compacted. Version 2 lines carry the resolved location, so no request is needed; plain-name lines
+// (old format or hand-edited) are queued on the geocoding pool and come back as lookups keyed by name,
+// with geocodePending set on the city until they finish.
+std::map<std::string, GeocodeJob> loadMyCityList(CityRegistry& cities, std::set<std::string>& favorites) {
+    auto addFavorite = [&](const City& place) {
+        favorites.insert(place.name);
+        City* found = cities.find(place.name);
+        if (!found) {
+            cities.add(place);
+            return;
+        }
+        City& city = *found;
+        if (!place.geocodePending && city.geocodePending) {
+            city.lon = place.lon;
+            city.lat = place.lat;
+            city.geocodePending = false;
+        }
+        if (!place.geocodePending && city.owmId == 0) {
+            city.owmId = place.owmId;
+        }
+        };
+
     std::ifstream infile(favorites_file);
-    std::string city;
-    while (std::getline(infile, city)) {
-        double lon, lat;
-        if (validateCity(city, lon, lat)) {
-            favorites.insert(city);
-            auto it = std::find_if(cities.begin(), cities.end(), [&city](const City& c) { return c.name == city; });
-            if (it == cities.end())
-                cities.push_back({ city, lon, lat, false, nullptr });
+    std::string line;
+    int version = 1;
+    if (std::getline(infile, line) && line.compare(0, favorites_header.size(), favorites_header) == 0) {
+        version = std::atoi(line.c_str() + favorites_header.size());
+        if (version > favorites_version) {
+            std::cerr << "favorites.txt is version " << version << ", reading it as version " << favorites_version << std::endl;
         }
     }
+    else {
+        infile.clear();
+        infile.seekg(0); // Old format: the first line is already a city
+    }
+    while (std::getline(infile, line)) {
+        if (!line.empty() && line[0] != '#') {
+            addFavorite(parseFavoriteLine(line));
+        }
+    }
+
+    // Replay the journal: "+<TAB>line" adds or updates a favorite, "-<TAB>name" removes one. A last line
+    // without its newline was cut off by a crash; it is ignored and cut from the file, or the next append
+    // would run on from it and corrupt its first record.
+    std::ifstream journalFile(favorites_journal_file, std::ios::binary);
+    std::string journal((std::istreambuf_iterator<char>(journalFile)), std::istreambuf_iterator<char>());
+    favoritesJournalRecords = 0;
+    size_t start = 0;
+    for (size_t end = journal.find('\n'); end != std::string::npos; start = end + 1, end = journal.find('\n', start)) {
+        std::string record = journal.substr(start, end - start);
+        if (record.size() < 2 || record[1] != '\t') {
+            continue; // Header or damaged line
+        }
+        if (record[0] == '+') {
+            addFavorite(parseFavoriteLine(record.substr(2)));
+        }
+        else if (record[0] == '-') {
+            favorites.erase(record.substr(2));
+        }
+        favoritesJournalRecords++;
+    }
+    if (start < journal.size() && !writeFileAtomically(favorites_journal_file, journal.substr(0, start))) {
+        saveMyCityList(cities, favorites);
+    }
+
+    std::map<std::string, GeocodeJob> lookups;
+    for (const auto& name : favorites) {
+        const City* city = cities.find(name);
+        if (city && city->geocodePending) {
+            lookups[name] = startCityLookup(name, geocodePool);
+        }
+    }
+    return lookups;
 }
 
-// Function to Save Cities to a MyList File
-void saveMyCityList(const std::set<std::string>& favorites) {
-    std::ofstream outfile(favorites_file);
-    for (const auto& city : favorites) {
-        outfile << city << std::endl;
+// Function to Load the App-State Snapshot: the city registry, favorites, selection and last-known weather.
+// Without a usable snapshot this falls back to the built-in cities plus favorites.txt. If favorites.txt
+// changed since the snapshot was taken (edited by hand, or written by an older version), the file decides
+// which cities are favorites and the snapshot only supplies locations.
+std::map<std::string, GeocodeJob> loadAppState(std::set<std::string>& favorites, std::map<std::string, bool>& selectedFavorites) {
+    AppSnapshot snapshot;
+    if (!snapshot.load(app_state_file)) {
+        return loadMyCityList(cities, favorites);
     }
+    bool favoritesCurrent = snapshot.favoritesHash == favoritesFingerprint();
+    std::map<std::string, GeocodeJob> lookups;
+    cities.clear();
+    cities.reserve(snapshot.places.size());
+    for (const auto& place : snapshot.places) {
+        City city = { place.name, place.lon, place.lat, false };
+        city.owmId = place.owmId;
+        city.geocodePending = (place.flags & AppSnapshot::GeocodePending) != 0;
+        bool selected = (place.flags & AppSnapshot::Selected) != 0;
+        if (place.flags & AppSnapshot::Favorite) {
+            if (favoritesCurrent) {
+                favorites.insert(place.name);
+                selectedFavorites[place.name] = selected;
+                if (city.geocodePending && lookups.find(place.name) == lookups.end()) {
+                    lookups[place.name] = startCityLookup(place.name, geocodePool);
+                }
+            }
+        }
+        else {
+            city.selected = selected;
+        }
+        cities.add(city);
+    }
+    if (!favoritesCurrent) {
+        std::map<std::string, GeocodeJob> fileLookups = loadMyCityList(cities, favorites);
+        lookups.insert(fileLookups.begin(), fileLookups.end());
+    }
+
+    // Keying and decoding the weather, and freeing the snapshot, happen on the lookup pool after the first frame
+    std::shared_ptr<AppSnapshot> restored = std::make_shared<AppSnapshot>();
+    std::swap(*restored, snapshot);
+    lookupPool.submit([restored]() {
+        int64_t oldestAllowed = static_cast<int64_t>(std::time(nullptr)) - weather_store_max_age_hours * 3600;
+        std::vector<WeatherStore::Record> records;
+        records.reserve(restored->weather.size());
+        for (auto& entry : restored->weather) {
+            if (entry.fetchedAt >= oldestAllowed) {
+                const AppSnapshot::Place& place = restored->places[entry.place];
+                WeatherStore::Record record = { locationKey(place.lat, place.lon), std::string(), entry.fetchedAt };
+                record.body.swap(entry.body);
+                records.push_back(std::move(record));
+            }
+        }
+        decodeRestoredWeather(records);
+        });
+    return lookups;
+}
+
+// Function to Snapshot the App State; favorites changes must already be saved so the fingerprint matches.
+// Only the places are copied here (UI thread); addCachedWeather fills in the weather later, off it.
+AppSnapshot captureAppState(const std::set<std::string>& favorites, const std::map<std::string, bool>& selectedFavorites) {
+    AppSnapshot snapshot;
+    snapshot.favoritesHash = favoritesFingerprint();
+    snapshot.places.reserve(cities.size());
+    for (const auto& city : cities) {
+        AppSnapshot::Place place = { city.name, city.lon, city.lat, city.owmId, 0 };
+        bool favorite = favorites.find(city.name) != favorites.end();
+        bool selected = city.selected;
+        if (favorite) {
+            auto it = selectedFavorites.find(city.name);
+            selected = it != selectedFavorites.end() && it->second;
+            place.flags |= AppSnapshot::Favorite;
+        }
+        if (selected) {
+            place.flags |= AppSnapshot::Selected;
+        }
+        if (city.geocodePending) {
+            place.flags |= AppSnapshot::GeocodePending;
+        }
+        snapshot.places.push_back(place);
+    }
+    return snapshot;
+}
+
+// Function to Add the Cached Weather of every Located Place to a Snapshot; the cache is thread-safe,
+// so this runs on the state writer
+void addCachedWeather(AppSnapshot& snapshot) {
+    int64_t now = static_cast<int64_t>(std::time(nullptr));
+    for (size_t i = 0; i < snapshot.places.size(); i++) {
+        const AppSnapshot::Place& place = snapshot.places[i];
+        if (place.flags & AppSnapshot::GeocodePending) {
+            continue;
+        }
+        WeatherSnapshot data;
+        std::chrono::seconds age;
+        if (weatherCache.peek(locationKey(place.lat, place.lon), data, age)) {
+            AppSnapshot::Weather entry = { static_cast<uint32_t>(i), now - age.count(), data.encode() };
+            snapshot.weather.push_back(entry);
+        }
+    }
+}
+
+// Function to Save the App State, in the background or (on exit) before returning.
+// Snapshots are numbered so a queued older one can never overwrite a newer one.
+void saveAppState(const std::set<std::string>& favorites, const std::map<std::string, bool>& selectedFavorites, bool wait) {
+    static std::mutex fileMutex;
+    static std::atomic<uint64_t> lastTaken(0);
+    static uint64_t lastWritten = 0;
+    std::shared_ptr<AppSnapshot> snapshot = std::make_shared<AppSnapshot>(captureAppState(favorites, selectedFavorites));
+    uint64_t sequence = ++lastTaken;
+    auto write = [snapshot, sequence]() {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        if (sequence > lastWritten) {
+            addCachedWeather(*snapshot);
+            writeFileAtomically(app_state_file, snapshot->serialize());
+            lastWritten = sequence;
+        }
+        };
+    if (wait) {
+        write();
+    }
+    else {
+        stateWriter.submit(write);
+    }
+}
+
+// Function to Save Cities to a MyList File: rewrite favorites.txt through a temp file and an atomic rename,
+// then empty the journal. A crash in between only means the journal is replayed over a file that
+// already contains it, which changes nothing.
+void saveMyCityList(const CityRegistry& cities, const std::set<std::string>& favorites) {
+    std::string contents = favorites_header + std::to_string(favorites_version) + "\n";
+    for (const auto& name : favorites) {
+        const City* city = cities.find(name);
+        contents += (city ? formatFavoriteLine(*city) : name) + "\n"; // Unknown location: name only
+    }
+    if (writeFileAtomically(favorites_file, contents)) {
+        std::ofstream(favorites_journal_file, std::ios::binary | std::ios::trunc);
+        favoritesJournalRecords = 0;
+    }
+}
+
+// Function to Record Favorites Changes: one small append per change instead of rewriting favorites.txt.
+// The journal is folded back into the file once it holds more records than the list itself.
+void journalFavorites(const std::vector<const City*>& added, const std::vector<std::string>& removed,
+    const CityRegistry& cities, const std::set<std::string>& favorites) {
+    if (added.empty() && removed.empty()) {
+        return;
+    }
+    size_t records = favoritesJournalRecords + added.size() + removed.size();
+    if (records > std::max(favorites_journal_min_compact, favorites.size())) {
+        saveMyCityList(cities, favorites);
+        return;
+    }
+    std::string changes;
+    if (favoritesJournalRecords == 0) {
+        changes += favorites_journal_header + "\n";
+    }
+    for (const City* city : added) {
+        changes += "+\t" + formatFavoriteLine(*city) + "\n";
+    }
+    for (const auto& name : removed) {
+        changes += "-\t" + name + "\n";
+    }
+    if (!appendToFileDurably(favorites_journal_file, changes)) {
+        std::cerr << "Failed to append to " << favorites_journal_file << ", rewriting favorites" << std::endl;
+        saveMyCityList(cities, favorites);
+        return;
+    }
+    favoritesJournalRecords = records;
+}
+
+// Function to Apply Finished Favorite Lookups (UI thread): a resolved favorite gets its location, and a
+// favorite is dropped only when the lookup answered that no such place exists. A failed lookup (offline,
+// timeout, quota, bad key) leaves the favorite as it is, to be retried on the next start. Both outcomes
+// are journaled, so the next start needs no request for them. Returns true if `favorites` changed.
+bool applyFavoriteLookups(std::map<std::string, GeocodeJob>& lookups, CityRegistry& cities,
+    std::set<std::string>& favorites, std::map<std::string, bool>& selectedFavorites) {
+    std::vector<const City*> resolved;
+    std::vector<std::string> notFound;
+    for (auto it = lookups.begin(); it != lookups.end();) {
+        const GeocodeJob& lookup = it->second;
+        if (!lookup->ready()) {
+            ++it;
+            continue;
+        }
+        const GeocodeResult& place = lookup->result();
+        City* city = cities.find(it->first);
+        if (lookup->failed()) {
+            std::cerr << "Could not resolve favorite " << it->first << ": " << lookup->error() << std::endl;
+        }
+        else if (city && place.found) {
+            city->lon = place.lon;
+            city->lat = place.lat;
+            city->geocodePending = false;
+            resolved.push_back(city);
+        }
+        else if (!place.found) {
+            std::cerr << "Favorite city not found: " << it->first << std::endl;
+            favorites.erase(it->first);
+            selectedFavorites.erase(it->first);
+            notFound.push_back(it->first);
+        }
+        it = lookups.erase(it);
+    }
+    journalFavorites(resolved, notFound, cities, favorites);
+    return !notFound.empty();
 }
 
 // Function to Add Selected Cities to MyList
-void addToMyCityList(const std::vector<City>& cities, std::set<std::string>& myList) {
+void addToMyCityList(const CityRegistry& cities, std::set<std::string>& myList) {
+    std::vector<const City*> added;
     for (const auto& city : cities) {
         if (city.selected && myList.find(city.name) == myList.end()) {
             myList.insert(city.name);
+            added.push_back(&city);
         }
     }
-    saveMyCityList(myList);
+    journalFavorites(added, std::vector<std::string>(), cities, myList);
 }
 
 // Function to Remove Selected Cities from MyList
-void removeFromMyList(const std::vector<City>& cities, std::set<std::string>& favorites) {
+void removeFromMyList(const CityRegistry& cities, std::set<std::string>& favorites) {
+    std::vector<std::string> removed;
     for (const auto& city : cities) {
-        if (city.selected) {
-            favorites.erase(city.name);
+        if (city.selected && favorites.erase(city.name) > 0) {
+            removed.push_back(city.name);
         }
     }
-    saveMyCityList(favorites);
+    journalFavorites(std::vector<const City*>(), removed, cities, favorites);
 }
 
 // Function to Filter and Return Only Favorite Cities
-std::vector<City> filterMyList(const std::vector<City>& cities, const std::set<std::string>& favorites) {
+std::vector<City> filterMyList(const CityRegistry& cities, const std::set<std::string>& favorites) {
     std::vector<City> filteredCities;
     for (const auto& city : cities) {
         if (favorites.find(city.name) != favorites.end()) {
@@ -160,17 +989,57 @@ std::vector<City> filterMyList(const std::vector<City>& cities, const std::set<s
     return filteredCities;
 }
 
-// Function to Convert Unix Time to HH:MM Format
-std::string unixToHHMM(int unixTime) {
-    std::time_t t = unixTime;
-    std::tm* tm = std::localtime(&t);
-    char buffer[6];
-    std::strftime(buffer, sizeof(buffer), "%H:%M", tm);
-    return std::string(buffer);
+// Function to List the Atlas Sources for Every OpenWeatherMap Icon Code, day and night.
+// An icon file from weather_icon_dir wins; night codes fall back to the day image and then
+// every code to the nearest of the bundled pictures.
+std::vector<IconAtlas::Source> weatherIconSources() {
+    const char* codes[][2] = {
+        { "01", "assets/sunny.png" },  // Clear sky
+        { "02", "assets/cloudy.png" }, // Few clouds
+        { "03", "assets/cloudy.png" }, // Scattered clouds
+        { "04", "assets/cloudy.png" }, // Broken clouds
+        { "09", "assets/rainy.png" },  // Shower rain and drizzle
+        { "10", "assets/rainy.png" },  // Rain
+        { "11", "assets/rainy.png" },  // Thunderstorm
+        { "13", "assets/rainy.png" },  // Snow
+        { "50", "assets/cloudy.png" }  // Mist, fog, haze and the other "Atmosphere" groups
+    };
+    std::vector<IconAtlas::Source> sources;
+    for (const auto& code : codes) {
+        IconAtlas::Source day, night;
+        day.key = std::string(code[0]) + "d";
+        night.key = std::string(code[0]) + "n";
+        day.files = { weather_icon_dir + day.key + ".png", code[1] };
+        night.files = { weather_icon_dir + night.key + ".png", weather_icon_dir + day.key + ".png", code[1] };
+        sources.push_back(day);
+        sources.push_back(night);
+    }
+    return sources;
+}
+
+// Function to Pick the Atlas Key for a Weather Snapshot: the icon code the API sent, or the
+// day icon of its condition group when the code is missing or unknown
+std::string weatherIconKey(const WeatherSnapshot& weatherData) {
+    IconAtlas::Icon unused;
+    if (iconAtlas.find(weatherData.icon, unused)) {
+        return weatherData.icon;
+    }
+    int condition = weatherData.conditionId;
+    if (condition == 800) {
+        return "01d"; // Clear
+    }
+    switch (condition / 100) {
+    case 2: return "11d"; // Thunderstorm
+    case 3: return "09d"; // Drizzle
+    case 5: return "10d"; // Rain
+    case 6: return "13d"; // Snow
+    case 8: return "03d"; // Clouds
+    default: return "50d"; // Mist, fog and the other "Atmosphere" groups
+    }
 }
 
 // Function to Uncheck All Cities
-void uncheckAllCities(std::vector<City>& cities) {
+void uncheckAllCities(CityRegistry& cities) {
     for (auto& city : cities) {
         city.selected = false;
     }
@@ -0,0 +1,97 @@
+#include "RateLimiter.h"
+#include <algorithm>
+
+RateLimiter::RateLimiter(double callsPerMinute, double burst, size_t maxConcurrency)
+    : ratePerSecond(callsPerMinute / 60.0), bucketSize(std::max(1.0, burst)), tokens(std::max(1.0, burst)),
+      lastRefill(Clock::now()), maxConcurrency(static_cast<double>(std::max<size_t>(1, maxConcurrency))),
+      concurrencyLimit(static_cast<double>(std::max<size_t>(1, maxConcurrency))), inFlight(0), throttled(0) {
+}
+
+void RateLimiter::refill(Clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+    tokens = std::min(bucketSize, tokens + elapsed * ratePerSecond);
+    lastRefill = now;
+}
+
+void RateLimiter::pruneRecentCalls(Clock::time_point now) const {
+    while (!recentCalls.empty() && now - recentCalls.front() > std::chrono::minutes(1)) {
+        recentCalls.pop_front();
+    }
+}
+
+// Function to Wait for Permission to Call the API
+bool RateLimiter::acquire(const CancellationToken* token) {
+    const std::chrono::milliseconds cancelPoll(50);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        if (token && token->isCancelled()) {
+            return false;
+        }
+        Clock::time_point now = Clock::now();
+        refill(now);
+        bool slotOpen = inFlight < static_cast<size_t>(concurrencyLimit);
+        if (slotOpen && tokens >= 1.0) {
+            tokens -= 1.0;
+            inFlight++;
+            recentCalls.push_back(now);
+            pruneRecentCalls(now);
+            return true;
+        }
+        // Sleep until a slot frees or the next token is due; cancellable waits re-check the token periodically
+        std::chrono::duration<double> wait(1.0);
+        if (slotOpen && ratePerSecond > 0.0) {
+            wait = std::chrono::duration<double>((1.0 - tokens) / ratePerSecond);
+        }
+        if (token && wait > cancelPoll) {
+            wait = cancelPoll;
+        }
+        if (!slotOpen && !token) {
+            slotFreed.wait(lock);
+        }
+        else {
+            slotFreed.wait_for(lock, wait);
+        }
+    }
+}
+
+// Function to Feed a Call's Outcome Back into the Concurrency Limit
+void RateLimiter::release(int status) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight--;
+        if (status == 429 || status >= 500) {
+            throttled++;
+            concurrencyLimit = std::max(1.0, concurrencyLimit / 2.0); // Multiplicative decrease
+            if (status == 429) {
+                tokens = std::min(tokens, 0.0); // The server says the budget is spent; wait for a refill
+            }
+        }
+        else if (status != 0) {
+            concurrencyLimit = std::min(maxConcurrency, concurrencyLimit + 1.0 / concurrencyLimit); // Additive increase
+        }
+    }
+    slotFreed.notify_all();
+}
+
+void RateLimiter::setRate(double callsPerMinute) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        refill(Clock::now());
+        ratePerSecond = callsPerMinute / 60.0;
+    }
+    slotFreed.notify_all();
+}
+
+RateLimiter::Stats RateLimiter::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    pruneRecentCalls(now);
+    Stats s;
+    s.callsLastMinute = recentCalls.size();
+    s.callsPerMinute = ratePerSecond * 60.0;
+    s.tokens = std::min(bucketSize, tokens + std::chrono::duration<double>(now - lastRefill).count() * ratePerSecond);
+    s.concurrencyLimit = concurrencyLimit;
+    s.inFlight = inFlight;
+    s.throttled = throttled;
+    return s;
+}
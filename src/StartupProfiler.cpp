@@ -0,0 +1,174 @@
+#include "StartupProfiler.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <mutex>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double millisecondsBetween(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// Nearest-rank percentile of sorted samples
+double percentileOf(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.999999);
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+std::string formatRow(const std::string& name, double a, double b, const char* note) {
+    char row[160];
+    std::snprintf(row, sizeof(row), "  %-28s %10.2f %10.2f  %s", name.c_str(), a, b, note);
+    return row;
+}
+
+}
+
+struct StartupProfiler::State {
+    Clock::time_point started;
+    Clock::time_point lastMark;
+    mutable std::mutex mutex;
+    mutable std::condition_variable backgroundDone;
+    std::vector<Phase> phases;
+    size_t pending;
+};
+
+StartupProfiler::StartupProfiler() : state(std::make_shared<State>()) {
+    state->started = Clock::now();
+    state->lastMark = state->started;
+    state->pending = 0;
+}
+
+void StartupProfiler::mark(const std::string& name) {
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(state->mutex);
+    Phase phase = { name, millisecondsBetween(state->started, state->lastMark), millisecondsBetween(state->lastMark, now), false };
+    state->phases.push_back(phase);
+    state->lastMark = now;
+}
+
+void StartupProfiler::runInBackground(WorkerPool& pool, const std::string& name, std::function<void()> work) {
+    std::shared_ptr<State> shared = state;
+    Clock::time_point submitted = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->pending++;
+    }
+    pool.submit([shared, name, work, submitted]() {
+        work();
+        Clock::time_point now = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            Phase phase = { name, millisecondsBetween(shared->started, submitted), millisecondsBetween(submitted, now), true };
+            shared->phases.push_back(phase);
+            shared->pending--;
+        }
+        shared->backgroundDone.notify_all();
+        });
+}
+
+void StartupProfiler::waitForBackground() const {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->backgroundDone.wait(lock, [this]() { return state->pending == 0; });
+}
+
+double StartupProfiler::elapsedMs() const {
+    return millisecondsBetween(state->started, Clock::now());
+}
+
+std::vector<StartupProfiler::Phase> StartupProfiler::phases() const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->phases;
+}
+
+size_t StartupProfiler::pendingBackground() const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->pending;
+}
+
+void StartupProfiler::report(std::ostream& out) const {
+    std::vector<Phase> all = phases();
+    out << "Startup profile (ms)" << std::endl;
+    char header[160];
+    std::snprintf(header, sizeof(header), "  %-28s %10s %10s", "phase", "start", "duration");
+    out << header << std::endl;
+    double foreground = 0.0;
+    for (const auto& phase : all) {
+        out << formatRow(phase.name, phase.startMs, phase.durationMs, phase.background ? "(background)" : "") << std::endl;
+        if (!phase.background) {
+            foreground = phase.startMs + phase.durationMs;
+        }
+    }
+    out << "  foreground total: " << foreground << " ms";
+    size_t pending = pendingBackground();
+    if (pending > 0) {
+        out << ", " << pending << " background phase(s) still running";
+    }
+    out << std::endl;
+}
+
+nlohmann::json StartupProfiler::toJson() const {
+    nlohmann::json phaseList = nlohmann::json::array();
+    double foreground = 0.0;
+    for (const auto& phase : phases()) {
+        phaseList.push_back({ {"name", phase.name}, {"startMs", phase.startMs}, {"durationMs", phase.durationMs},
+            {"background", phase.background} });
+        if (!phase.background) {
+            foreground = phase.startMs + phase.durationMs;
+        }
+    }
+    return { {"phases", phaseList}, {"foregroundMs", foreground}, {"pendingBackground", pendingBackground()} };
+}
+
+nlohmann::json StartupProfiler::summarize(const std::vector<std::vector<Phase>>& runs) {
+    // Durations per phase name, in first-seen order; "total" is the end of the last foreground phase
+    std::vector<std::string> order;
+    std::map<std::string, std::vector<double>> samples;
+    std::map<std::string, bool> background;
+    for (const auto& run : runs) {
+        double total = 0.0;
+        for (const auto& phase : run) {
+            if (samples.find(phase.name) == samples.end()) {
+                order.push_back(phase.name);
+                background[phase.name] = phase.background;
+            }
+            samples[phase.name].push_back(phase.durationMs);
+            if (!phase.background) {
+                total = std::max(total, phase.startMs + phase.durationMs);
+            }
+        }
+        samples["total"].push_back(total);
+    }
+    order.push_back("total");
+    background["total"] = false;
+
+    nlohmann::json phaseList = nlohmann::json::array();
+    for (const auto& name : order) {
+        std::vector<double>& values = samples[name];
+        std::sort(values.begin(), values.end());
+        phaseList.push_back({ {"name", name}, {"background", background[name]}, {"samples", values.size()},
+            {"p50Ms", percentileOf(values, 50.0)}, {"p90Ms", percentileOf(values, 90.0)},
+            {"p99Ms", percentileOf(values, 99.0)}, {"maxMs", values.empty() ? 0.0 : values.back()} });
+    }
+    return { {"runs", runs.size()}, {"phases", phaseList} };
+}
+
+void StartupProfiler::reportSummary(const nlohmann::json& summary, std::ostream& out) {
+    out << "Startup benchmark, " << summary["runs"].get<size_t>() << " runs (ms)" << std::endl;
+    char header[160];
+    std::snprintf(header, sizeof(header), "  %-28s %10s %10s %10s %10s", "phase", "p50", "p90", "p99", "max");
+    out << header << std::endl;
+    for (const auto& phase : summary["phases"]) {
+        char row[160];
+        std::snprintf(row, sizeof(row), "  %-28s %10.2f %10.2f %10.2f %10.2f%s", phase["name"].get<std::string>().c_str(),
+            phase["p50Ms"].get<double>(), phase["p90Ms"].get<double>(), phase["p99Ms"].get<double>(),
+            phase["maxMs"].get<double>(), phase["background"].get<bool>() ? "  (background)" : "");
+        out << row << std::endl;
+    }
+}
@@ -0,0 +1,76 @@
+#include "WeatherCache.h"
+
+WeatherCache::WeatherCache(std::chrono::seconds ttl, size_t capacity)
+    : timeToLive(ttl), maxEntries(capacity > 0 ? capacity : 1), evictedCount(0), hitCount(0), staleCount(0), missCount(0) {
+}
+
+// Function to Move an Entry to the Front of the Recency List
+void WeatherCache::touch(Entry& entry) {
+    recency.splice(recency.begin(), recency, entry.recent);
+}
+
+// Function to Look Up a Location, copying out whatever is cached even when it has expired
+WeatherCache::Lookup WeatherCache::get(const std::string& key, WeatherSnapshot& data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        missCount++;
+        return Lookup::Miss;
+    }
+    data = it->second.data;
+    touch(it->second);
+    if (std::chrono::steady_clock::now() - it->second.fetchedAt < timeToLive) {
+        hitCount++;
+        return Lookup::Fresh;
+    }
+    staleCount++;
+    return Lookup::Stale;
+}
+
+// Function to Store an Entry, evicting the least recently used one if the cache is full
+void WeatherCache::put(const std::string& key, const WeatherSnapshot& data, std::chrono::seconds age) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        if (entries.size() >= maxEntries) {
+            entries.erase(recency.back());
+            recency.pop_back();
+            evictedCount++;
+        }
+        recency.push_front(key);
+        it = entries.insert(std::make_pair(key, Entry())).first;
+        it->second.recent = recency.begin();
+    }
+    else {
+        touch(it->second);
+    }
+    it->second.data = data;
+    it->second.fetchedAt = std::chrono::steady_clock::now() - age;
+}
+
+bool WeatherCache::peek(const std::string& key, WeatherSnapshot& data, std::chrono::seconds& age) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return false;
+    }
+    data = it->second.data;
+    age = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - it->second.fetchedAt);
+    return true;
+}
+
+std::chrono::seconds WeatherCache::ttl() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return timeToLive;
+}
+
+WeatherCache::Stats WeatherCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats s;
+    s.hits = hitCount;
+    s.stale = staleCount;
+    s.misses = missCount;
+    s.entries = entries.size();
+    s.evicted = evictedCount;
+    return s;
+}
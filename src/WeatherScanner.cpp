@@ -0,0 +1,552 @@
+#ifdef MWA_FAST_WEATHER_PARSER
+
+#include "WeatherScanner.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(MWA_SCANNER_FORCE_SCALAR)
+// The portable loop even where SIMD is available, to compare the kernels
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define MWA_SCANNER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWA_SCANNER_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+const size_t block_size = 64;
+const int max_depth = 32; // Weather responses nest three deep; anything far deeper goes to the SAX parser
+
+// Bit i of each mask describes byte i of one 64-byte block
+struct BlockMasks {
+    uint64_t quotes;
+    uint64_t backslashes;
+    uint64_t structurals; // { } [ ] : , (and two control bytes, which the walk rejects)
+    uint64_t controls;    // Bytes below 0x20
+    uint64_t nonAscii;
+};
+
+#if defined(MWA_SCANNER_AVX2) || defined(MWA_SCANNER_SSE2)
+
+#ifdef MWA_SCANNER_AVX2
+typedef __m256i Lane;
+const size_t lane_size = 32;
+inline Lane loadLane(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+inline Lane splat(char c) { return _mm256_set1_epi8(c); }
+inline Lane bitOr(Lane a, Lane b) { return _mm256_or_si256(a, b); }
+inline Lane unsignedMax(Lane a, Lane b) { return _mm256_max_epu8(a, b); }
+inline uint64_t highBits(Lane v) { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+inline uint64_t equalBits(Lane a, Lane b) { return highBits(_mm256_cmpeq_epi8(a, b)); }
+#else
+typedef __m128i Lane;
+const size_t lane_size = 16;
+inline Lane loadLane(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline Lane splat(char c) { return _mm_set1_epi8(c); }
+inline Lane bitOr(Lane a, Lane b) { return _mm_or_si128(a, b); }
+inline Lane unsignedMax(Lane a, Lane b) { return _mm_max_epu8(a, b); }
+inline uint64_t highBits(Lane v) { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+inline uint64_t equalBits(Lane a, Lane b) { return highBits(_mm_cmpeq_epi8(a, b)); }
+#endif
+
+BlockMasks classify(const char* block) {
+    BlockMasks masks = {};
+    for (size_t offset = 0; offset < block_size; offset += lane_size) {
+        Lane bytes = loadLane(block + offset);
+        // '[' and ']' differ from '{' and '}' only in bit 5, so setting it folds four compares into two
+        Lane folded = bitOr(bytes, splat(0x20));
+        masks.quotes |= equalBits(bytes, splat('"')) << offset;
+        masks.backslashes |= equalBits(bytes, splat('\\')) << offset;
+        masks.structurals |= (equalBits(folded, splat('{')) | equalBits(folded, splat('}')) |
+            equalBits(folded, splat(':')) | equalBits(folded, splat(','))) << offset;
+        masks.controls |= equalBits(unsignedMax(bytes, splat(0x1F)), splat(0x1F)) << offset;
+        masks.nonAscii |= highBits(bytes) << offset;
+    }
+    return masks;
+}
+
+#else
+
+BlockMasks classify(const char* block) {
+    BlockMasks masks = {};
+    for (size_t i = 0; i < block_size; ++i) {
+        unsigned char c = static_cast<unsigned char>(block[i]);
+        uint64_t bit = static_cast<uint64_t>(1) << i;
+        switch (c) {
+        case '"': masks.quotes |= bit; break;
+        case '\\': masks.backslashes |= bit; break;
+        case '{': case '}': case '[': case ']': case ':': case ',': masks.structurals |= bit; break;
+        default: break;
+        }
+        if (c < 0x20) masks.controls |= bit;
+        if (c >= 0x80) masks.nonAscii |= bit;
+    }
+    return masks;
+}
+
+#endif
+
+inline int trailingZeros(uint64_t bits) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+// Bit i becomes the XOR of bits 0..i: set from an opening quote up to (not including) its closing one
+inline uint64_t prefixXor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// Function to Index Every Quote and Every Structural Character Outside Strings. Returns false for
+// bodies with backslashes (escapes are left to the general parser), raw control bytes inside a string
+// or an unterminated string.
+bool indexStructurals(const char* text, size_t size, std::vector<uint32_t>& index, size_t& count, bool& nonAscii) {
+    if (index.size() < size + 1) {
+        index.resize(size + 1); // At most one entry per byte; grows once per thread, then reused
+    }
+    uint32_t* out = index.data();
+    count = 0;
+    uint64_t insideCarry = 0;
+    uint64_t anyNonAscii = 0;
+    char tail[block_size];
+    for (size_t base = 0; base < size; base += block_size) {
+        const char* block = text + base;
+        if (size - base < block_size) {
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, block, size - base);
+            block = tail;
+        }
+        BlockMasks masks = classify(block);
+        if (masks.backslashes) {
+            return false;
+        }
+        uint64_t inside = prefixXor(masks.quotes) ^ insideCarry;
+        if (masks.controls & inside) {
+            return false;
+        }
+        insideCarry = 0 - (inside >> 63);
+        anyNonAscii |= masks.nonAscii;
+        uint64_t wanted = (masks.structurals & ~inside) | masks.quotes;
+        while (wanted) {
+            out[count++] = static_cast<uint32_t>(base + trailingZeros(wanted));
+            wanted &= wanted - 1;
+        }
+    }
+    nonAscii = anyNonAscii != 0;
+    return insideCarry == 0;
+}
+
+// Function to Check UTF-8 the Way the JSON Grammar Demands (no overlong forms, surrogates or values
+// past U+10FFFF)
+bool validUtf8(const unsigned char* p, size_t size) {
+    const unsigned char* end = p + size;
+    while (p < end) {
+        unsigned char c = *p;
+        if (c < 0x80) {
+            ++p;
+            continue;
+        }
+        size_t length;
+        unsigned char low = 0x80, high = 0xBF; // Allowed range of the second byte
+        if (c >= 0xC2 && c <= 0xDF) length = 2;
+        else if (c >= 0xE0 && c <= 0xEF) {
+            length = 3;
+            if (c == 0xE0) low = 0xA0;
+            else if (c == 0xED) high = 0x9F;
+        }
+        else if (c >= 0xF0 && c <= 0xF4) {
+            length = 4;
+            if (c == 0xF0) low = 0x90;
+            else if (c == 0xF4) high = 0x8F;
+        }
+        else return false;
+        if (static_cast<size_t>(end - p) < length || p[1] < low || p[1] > high) {
+            return false;
+        }
+        for (size_t i = 2; i < length; ++i) {
+            if (p[i] < 0x80 || p[i] > 0xBF) {
+                return false;
+            }
+        }
+        p += length;
+    }
+    return true;
+}
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+template <size_t N>
+inline bool keyIs(const TextSpan& key, const char (&name)[N]) {
+    return key.size == N - 1 && std::memcmp(key.data, name, N - 1) == 0;
+}
+
+struct Number {
+    bool integral;  // Written without a fraction or exponent
+    int64_t whole;  // Integer value (truncated for non-integral numbers)
+    double value;
+};
+
+// Powers of ten that a double holds exactly
+const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Function to Add One Decimal Digit to a Mantissa of at most 19 significant digits; `scale` tracks
+// the power of ten the mantissa is then multiplied by, and `exact` drops once a digit is lost
+inline void addDigit(unsigned digit, bool inFraction, uint64_t& mantissa, int& significant, int& scale, bool& exact) {
+    if (mantissa == 0 && digit == 0) {
+        if (inFraction) --scale; // Leading zero
+        return;
+    }
+    if (significant < 19) {
+        mantissa = mantissa * 10 + digit;
+        ++significant;
+        if (inFraction) --scale;
+    }
+    else {
+        exact = false;
+        if (!inFraction) ++scale;
+    }
+}
+
+// Function to Parse a JSON Number in Place. Integers are read exactly (false if one does not fit an
+// int64). A decimal of up to 19 significant digits whose mantissa fits 53 bits and whose power of ten
+// is within 1e±22 is one exact multiply or divide, hence correctly rounded (Clinger's fast path); the
+// rest go through strtod on a stack copy.
+bool parseNumber(const char* p, size_t length, Number& number) {
+    const char* start = p;
+    const char* end = p + length;
+    bool negative = *p == '-';
+    if (negative) {
+        ++p;
+    }
+    if (p == end || !isDigit(*p)) {
+        return false;
+    }
+    const char* integerStart = p;
+    if (*p == '0') {
+        ++p;
+    }
+    else {
+        while (p < end && isDigit(*p)) ++p;
+    }
+    const char* integerEnd = p;
+    const char* fractionStart = p;
+    const char* fractionEnd = p;
+    if (p < end && *p == '.') {
+        fractionStart = ++p;
+        while (p < end && isDigit(*p)) ++p;
+        if (p == fractionStart) {
+            return false;
+        }
+        fractionEnd = p;
+    }
+    int exponent = 0;
+    bool hasExponent = false;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        hasExponent = true;
+        ++p;
+        bool exponentNegative = false;
+        if (p < end && (*p == '+' || *p == '-')) {
+            exponentNegative = *p == '-';
+            ++p;
+        }
+        const char* exponentStart = p;
+        while (p < end && isDigit(*p)) {
+            if (exponent < 100000) exponent = exponent * 10 + (*p - '0');
+            ++p;
+        }
+        if (p == exponentStart) {
+            return false;
+        }
+        if (exponentNegative) exponent = -exponent;
+    }
+    if (p != end) {
+        return false;
+    }
+
+    number.integral = fractionStart == fractionEnd && !hasExponent;
+    if (number.integral) {
+        const uint64_t limit = static_cast<uint64_t>(INT64_MAX) + (negative ? 1 : 0);
+        uint64_t magnitude = 0;
+        for (const char* q = integerStart; q < integerEnd; ++q) {
+            unsigned digit = static_cast<unsigned>(*q - '0');
+            if (magnitude > (limit - digit) / 10) {
+                return false;
+            }
+            magnitude = magnitude * 10 + digit;
+        }
+        number.whole = negative ? -static_cast<int64_t>(magnitude - 1) - 1 : static_cast<int64_t>(magnitude);
+        number.value = static_cast<double>(number.whole);
+        return true;
+    }
+
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int scale = 0;
+    bool exact = true;
+    for (const char* q = integerStart; q < integerEnd; ++q) {
+        addDigit(static_cast<unsigned>(*q - '0'), false, mantissa, significant, scale, exact);
+    }
+    for (const char* q = fractionStart; q < fractionEnd; ++q) {
+        addDigit(static_cast<unsigned>(*q - '0'), true, mantissa, significant, scale, exact);
+    }
+    int powerOfTen = scale + exponent;
+    double value;
+    if (mantissa == 0) {
+        value = 0.0;
+    }
+    else if (exact && mantissa <= (static_cast<uint64_t>(1) << 53) && powerOfTen >= -22 && powerOfTen <= 22) {
+        value = static_cast<double>(mantissa);
+        value = powerOfTen < 0 ? value / exact_powers_of_ten[-powerOfTen] : value * exact_powers_of_ten[powerOfTen];
+    }
+    else {
+        char copy[64];
+        if (length >= sizeof(copy)) {
+            return false;
+        }
+        std::memcpy(copy, start, length);
+        copy[length] = '\0';
+        value = std::fabs(std::strtod(copy, nullptr));
+        if (!std::isfinite(value)) {
+            return false;
+        }
+    }
+    number.value = negative ? -value : value;
+    number.whole = std::fabs(number.value) < 9.2e18 ? static_cast<int64_t>(number.value) : 0;
+    return true;
+}
+
+// Weather Walker: Second stage of the scan. Steps through the structural index checking the JSON
+// grammar (everything between index entries must be whitespace or one scalar token) and records the
+// wanted fields by their place in the schema, like the SAX extractor does.
+class WeatherWalker {
+public:
+    WeatherWalker(const char* text, size_t size, const uint32_t* index, size_t count, WeatherFields& fields)
+        : text(text), size(size), index(index), count(count), next(0), end(0), fields(fields) {}
+
+    bool run() {
+        if (count == 0 || text[index[0]] != '{' || !spaceBetween(0, index[0])) {
+            return false; // Weather responses are objects; leave other documents to the SAX parser
+        }
+        return object(Root, 0) && next == count && spaceBetween(end, size);
+    }
+
+private:
+    enum Block { Root, MainBlock, WindBlock, SysBlock, WeatherArray, FirstWeather, Other };
+
+    char at(size_t entry) const { return text[index[entry]]; }
+
+    bool spaceBetween(size_t from, size_t to) const {
+        for (; from < to; ++from) {
+            if (!isSpace(text[from])) return false;
+        }
+        return true;
+    }
+
+    // Consume the ',' or closing bracket after a value; `closer` is '}' or ']'
+    bool separator(char closer, bool& closed) {
+        if (next >= count || !spaceBetween(end, index[next])) {
+            return false;
+        }
+        char c = at(next);
+        end = index[next++] + 1;
+        closed = c == closer;
+        return closed || c == ',';
+    }
+
+    bool object(Block block, int depth) {
+        if (depth > max_depth) {
+            return false;
+        }
+        if (block == MainBlock) {
+            fields.hasMain = true;
+        }
+        end = index[next++] + 1;
+        if (next < count && at(next) == '}' && spaceBetween(end, index[next])) {
+            end = index[next++] + 1;
+            return true;
+        }
+        for (bool closed = false; !closed;) {
+            if (next + 2 >= count || at(next) != '"' || at(next + 1) != '"' || at(next + 2) != ':' ||
+                !spaceBetween(end, index[next]) || !spaceBetween(index[next + 1] + 1, index[next + 2])) {
+                return false;
+            }
+            TextSpan key = { text + index[next] + 1, index[next + 1] - index[next] - 1 };
+            end = index[next + 2] + 1;
+            next += 3;
+            if (!value(block, key, -1, depth) || !separator('}', closed)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool array(Block block, int depth) {
+        if (depth > max_depth) {
+            return false;
+        }
+        end = index[next++] + 1;
+        if (next < count && at(next) == ']' && spaceBetween(end, index[next])) {
+            end = index[next++] + 1;
+            return true;
+        }
+        TextSpan noKey = { text, 0 };
+        bool closed = false;
+        for (int element = 0; !closed; ++element) {
+            if (!value(block, noKey, element, depth) || !separator(']', closed)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // One value, starting just after the ':', ',' or '[' at `end`; `element` is its array position,
+    // or -1 for an object member named `key`
+    bool value(Block parent, const TextSpan& key, int element, int depth) {
+        if (next >= count) {
+            return false;
+        }
+        char c = at(next);
+        if (c == '"' || c == '{' || c == '[') {
+            if (!spaceBetween(end, index[next])) {
+                return false;
+            }
+        }
+        if (c == '"') {
+            if (next + 1 >= count) {
+                return false;
+            }
+            TextSpan span = { text + index[next] + 1, index[next + 1] - index[next] - 1 };
+            end = index[next + 1] + 1;
+            next += 2;
+            if (parent == FirstWeather) {
+                if (keyIs(key, "description")) fields.description = span;
+                else if (keyIs(key, "icon")) fields.icon = span;
+            }
+            return true;
+        }
+        if (c == '{') {
+            Block block = Other;
+            if (parent == Root && element < 0) {
+                block = keyIs(key, "main") ? MainBlock : keyIs(key, "wind") ? WindBlock : keyIs(key, "sys") ? SysBlock : Other;
+            }
+            else if (parent == WeatherArray && element == 0) {
+                block = FirstWeather;
+            }
+            return object(block, depth + 1);
+        }
+        if (c == '[') {
+            return array(parent == Root && keyIs(key, "weather") ? WeatherArray : Other, depth + 1);
+        }
+        return scalar(parent, key, end, index[next]);
+    }
+
+    // A literal or number filling [from, to) apart from surrounding whitespace
+    bool scalar(Block parent, const TextSpan& key, size_t from, size_t to) {
+        end = to;
+        while (from < to && isSpace(text[from])) ++from;
+        while (to > from && isSpace(text[to - 1])) --to;
+        size_t length = to - from;
+        const char* token = text + from;
+        if (length == 0) {
+            return false;
+        }
+        if (*token == 't' || *token == 'f' || *token == 'n') {
+            return (length == 4 && std::memcmp(token, "true", 4) == 0) ||
+                (length == 5 && std::memcmp(token, "false", 5) == 0) ||
+                (length == 4 && std::memcmp(token, "null", 4) == 0);
+        }
+        Number number;
+        if (!parseNumber(token, length, number)) {
+            return false;
+        }
+        switch (parent) {
+        case Root:
+            if (keyIs(key, "id")) fields.cityId = number.whole;
+            break;
+        case MainBlock:
+            if (keyIs(key, "temp")) fields.temperature = number.value;
+            else if (keyIs(key, "humidity")) fields.humidity = number.whole;
+            break;
+        case WindBlock:
+            if (keyIs(key, "speed")) fields.windSpeed = number.value;
+            break;
+        case SysBlock:
+            if (keyIs(key, "sunrise")) fields.sunrise = number.whole;
+            else if (keyIs(key, "sunset")) fields.sunset = number.whole;
+            break;
+        case FirstWeather:
+            if (keyIs(key, "id")) fields.conditionId = number.whole;
+            break;
+        default:
+            break;
+        }
+        return true;
+    }
+
+    const char* text;
+    size_t size;
+    const uint32_t* index;
+    size_t count;
+    size_t next; // Next index entry to consume
+    size_t end;  // Byte just past the last thing consumed
+    WeatherFields& fields;
+};
+
+}
+
+WeatherScanner::Result WeatherScanner::scan(const std::string& body, WeatherFields& fields) {
+    fields = WeatherFields();
+    if (body.size() >= UINT32_MAX) {
+        return Unsupported;
+    }
+    static thread_local std::vector<uint32_t> index;
+    size_t count = 0;
+    bool nonAscii = false;
+    if (!indexStructurals(body.data(), body.size(), index, count, nonAscii) ||
+        (nonAscii && !validUtf8(reinterpret_cast<const unsigned char*>(body.data()), body.size()))) {
+        return Unsupported;
+    }
+    WeatherWalker walker(body.data(), body.size(), index.data(), count, fields);
+    if (!walker.run()) {
+        fields = WeatherFields();
+        return Unsupported;
+    }
+    return fields.hasMain ? Parsed : NotWeather;
+}
+
+const char* WeatherScanner::kernel() {
+#if defined(MWA_SCANNER_AVX2)
+    return "avx2";
+#elif defined(MWA_SCANNER_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+#endif // MWA_FAST_WEATHER_PARSER
@@ -0,0 +1,343 @@
+#include "WeatherSnapshot.h"
+#ifdef MWA_FAST_WEATHER_PARSER
+#include "WeatherScanner.h"
+#include <algorithm>
+#endif
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <unordered_set>
+
+namespace {
+
+// Encoded snapshot: tag, city id, condition id, icon, temperature, humidity, wind speed, sunrise,
+// sunset, description length (56 bytes), then the description bytes.
+const char snapshot_tag[4] = { 'W', 'S', 'N', '1' };
+const size_t encoded_fixed_size = 56;
+const size_t max_thread_interned_texts = 64; // OpenWeatherMap has about 55 condition descriptions per language
+
+template <typename T>
+void writeField(std::string& out, size_t offset, T value) {
+    std::memcpy(&out[offset], &value, sizeof(value));
+}
+
+template <typename T>
+T readField(const char* base, size_t offset) {
+    T value;
+    std::memcpy(&value, base + offset, sizeof(value));
+    return value;
+}
+
+// Function to Format Unix Time as Local HH:MM; safe on worker threads, unlike std::localtime
+void formatLocalTime(int64_t unixTime, char (&out)[6]) {
+    std::time_t t = static_cast<std::time_t>(unixTime);
+    std::tm local;
+#ifdef _WIN32
+    localtime_s(&local, &t);
+#else
+    localtime_r(&t, &local);
+#endif
+    std::strftime(out, sizeof(out), "%H:%M", &local);
+}
+
+// Weather Extractor: SAX handler that copies the fields of WeatherSnapshot out of a current-weather
+// response, or out of every entry of a /group "list", as the parser reads them. Containers it does
+// not care about are skipped by depth alone, so no values outside the wanted fields are kept.
+class WeatherExtractor : public nlohmann::json_sax<nlohmann::json> {
+public:
+    WeatherExtractor(bool group, std::vector<WeatherSnapshot>& out) : sawList(false), group(group), out(out) {
+        stack.reserve(8); // Group responses nest five deep; deeper skipped blocks are rare
+    }
+
+    bool sawList;
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t value) override { number(static_cast<double>(value), value); return true; }
+    bool number_unsigned(number_unsigned_t value) override {
+        number(static_cast<double>(value), static_cast<int64_t>(value));
+        return true;
+    }
+    bool number_float(number_float_t value, const string_t&) override { number(value, static_cast<int64_t>(value)); return true; }
+    bool binary(binary_t&) override { return true; }
+
+    bool string(string_t& value) override {
+        if (top() == FirstWeather && current) {
+            if (currentKey == "description") {
+                current->description = internWeatherText(value.data(), value.size());
+            }
+            else if (currentKey == "icon") {
+                std::strncpy(current->icon, value.c_str(), sizeof(current->icon) - 1);
+            }
+        }
+        return true;
+    }
+
+    bool key(string_t& value) override {
+        currentKey = value;
+        return true;
+    }
+
+    bool start_object(std::size_t) override {
+        Frame parent = top();
+        Frame frame = Skip;
+        if (stack.empty()) {
+            frame = group ? GroupRoot : Response;
+        }
+        else if (parent == ListArray) {
+            frame = Response;
+        }
+        else if (parent == Response) {
+            frame = currentKey == "main" ? MainBlock : currentKey == "wind" ? WindBlock : currentKey == "sys" ? SysBlock : Skip;
+        }
+        else if (parent == WeatherArray) {
+            frame = weatherEntries++ == 0 ? FirstWeather : Skip;
+        }
+        if (frame == Response) {
+            out.push_back(WeatherSnapshot());
+            current = &out.back();
+            current->description = internWeatherText("", 0);
+        }
+        else if (frame == MainBlock && current) {
+            current->valid = true;
+        }
+        stack.push_back(frame);
+        return true;
+    }
+
+    bool end_object() override {
+        if (top() == Response && current) {
+            formatLocalTime(current->sunrise, current->sunriseText);
+            formatLocalTime(current->sunset, current->sunsetText);
+            if (!current->valid) {
+                out.pop_back(); // Not a weather entry (e.g. an error body)
+            }
+            current = nullptr;
+        }
+        stack.pop_back();
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        Frame frame = Skip;
+        if (top() == Response && currentKey == "weather") {
+            frame = WeatherArray;
+            weatherEntries = 0;
+        }
+        else if (top() == GroupRoot && currentKey == "list") {
+            frame = ListArray;
+            sawList = true;
+        }
+        stack.push_back(frame);
+        return true;
+    }
+
+    bool end_array() override {
+        stack.pop_back();
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+        return false;
+    }
+
+private:
+    enum Frame { None, GroupRoot, ListArray, Response, MainBlock, WindBlock, SysBlock, WeatherArray, FirstWeather, Skip };
+
+    Frame top() const { return stack.empty() ? None : stack.back(); }
+
+    void number(double value, int64_t whole) {
+        if (!current) {
+            return;
+        }
+        switch (top()) {
+        case Response:
+            if (currentKey == "id") current->cityId = static_cast<int>(whole);
+            break;
+        case MainBlock:
+            if (currentKey == "temp") current->temperature = value;
+            else if (currentKey == "humidity") current->humidity = static_cast<int>(whole);
+            break;
+        case WindBlock:
+            if (currentKey == "speed") current->windSpeed = value;
+            break;
+        case SysBlock:
+            if (currentKey == "sunrise") current->sunrise = whole;
+            else if (currentKey == "sunset") current->sunset = whole;
+            break;
+        case FirstWeather:
+            if (currentKey == "id") current->conditionId = static_cast<int>(whole);
+            break;
+        default:
+            break;
+        }
+    }
+
+    bool group;
+    std::vector<WeatherSnapshot>& out;
+    std::vector<Frame> stack;
+    std::string currentKey;
+    WeatherSnapshot* current = nullptr;
+    int weatherEntries = 0;
+};
+
+// Function to Parse One Response with the SAX Extractor
+bool saxParse(const std::string& body, WeatherSnapshot& snapshot) {
+    std::vector<WeatherSnapshot> found;
+    found.reserve(1);
+    WeatherExtractor extractor(false, found);
+    if (!nlohmann::json::sax_parse(body.data(), body.data() + body.size(), &extractor) || found.empty()) {
+        return false;
+    }
+    snapshot = found.front();
+    return true;
+}
+
+#ifdef MWA_FAST_WEATHER_PARSER
+// Function to Build a Snapshot from Scanned Fields, with the same conversions the SAX extractor makes
+WeatherSnapshot fromFields(const WeatherFields& fields) {
+    WeatherSnapshot snapshot = {};
+    snapshot.valid = true;
+    snapshot.cityId = static_cast<int>(fields.cityId);
+    snapshot.conditionId = static_cast<int>(fields.conditionId);
+    size_t iconSize = std::min(fields.icon.size, sizeof(snapshot.icon) - 1);
+    if (iconSize > 0) {
+        std::memcpy(snapshot.icon, fields.icon.data, iconSize);
+    }
+    snapshot.description = internWeatherText(fields.description.data, fields.description.size);
+    snapshot.temperature = fields.temperature;
+    snapshot.humidity = static_cast<int>(fields.humidity);
+    snapshot.windSpeed = fields.windSpeed;
+    snapshot.sunrise = fields.sunrise;
+    snapshot.sunset = fields.sunset;
+    formatLocalTime(snapshot.sunrise, snapshot.sunriseText);
+    formatLocalTime(snapshot.sunset, snapshot.sunsetText);
+    return snapshot;
+}
+#endif
+
+}
+
+const char* internWeatherText(const std::string& text) {
+    static std::mutex mutex;
+    static std::unordered_set<std::string> texts; // Nodes never move, so c_str() stays valid
+    std::lock_guard<std::mutex> lock(mutex);
+    return texts.insert(text).first->c_str();
+}
+
+const char* internWeatherText(const char* data, size_t size) {
+    // The texts a thread has seen, so repeats (nearly every response) need no string and no lock
+    static thread_local std::vector<std::pair<const char*, size_t>> seen;
+    if (size == 0) {
+        data = ""; // An empty span may have no buffer behind it
+    }
+    for (const auto& text : seen) {
+        if (text.second == size && std::memcmp(text.first, data, size) == 0) {
+            return text.first;
+        }
+    }
+    const char* interned = internWeatherText(std::string(data, size));
+    if (seen.size() < max_thread_interned_texts) {
+        seen.push_back(std::make_pair(interned, size));
+    }
+    return interned;
+}
+
+WeatherSnapshot WeatherSnapshot::fromJson(const nlohmann::json& data) {
+    WeatherSnapshot snapshot = {};
+    if (!data.is_object() || !data.contains("main") || !data["main"].is_object()) {
+        return snapshot;
+    }
+    const nlohmann::json& main = data["main"];
+    snapshot.valid = true;
+    snapshot.cityId = data.value("id", 0);
+    snapshot.temperature = main.value("temp", 0.0);
+    snapshot.humidity = main.value("humidity", 0);
+    if (data.contains("wind") && data["wind"].is_object()) {
+        snapshot.windSpeed = data["wind"].value("speed", 0.0);
+    }
+    if (data.contains("sys") && data["sys"].is_object()) {
+        snapshot.sunrise = data["sys"].value("sunrise", static_cast<int64_t>(0));
+        snapshot.sunset = data["sys"].value("sunset", static_cast<int64_t>(0));
+    }
+    std::string description;
+    if (data.contains("weather") && data["weather"].is_array() && !data["weather"].empty() && data["weather"][0].is_object()) {
+        const nlohmann::json& weather = data["weather"][0];
+        snapshot.conditionId = weather.value("id", 0);
+        description = weather.value("description", "");
+        std::string icon = weather.value("icon", "");
+        std::strncpy(snapshot.icon, icon.c_str(), sizeof(snapshot.icon) - 1);
+    }
+    snapshot.description = internWeatherText(description);
+    formatLocalTime(snapshot.sunrise, snapshot.sunriseText);
+    formatLocalTime(snapshot.sunset, snapshot.sunsetText);
+    return snapshot;
+}
+
+bool WeatherSnapshot::parse(const std::string& body, WeatherSnapshot& snapshot) {
+#ifdef MWA_FAST_WEATHER_PARSER
+    WeatherFields fields;
+    WeatherScanner::Result scanned = WeatherScanner::scan(body, fields);
+    if (scanned != WeatherScanner::Unsupported) {
+        if (scanned == WeatherScanner::Parsed) {
+            snapshot = fromFields(fields);
+        }
+        return scanned == WeatherScanner::Parsed;
+    }
+#endif
+    return saxParse(body, snapshot);
+}
+
+bool WeatherSnapshot::parseList(const std::string& body, std::vector<WeatherSnapshot>& snapshots) {
+    std::vector<WeatherSnapshot> found;
+    WeatherExtractor extractor(true, found);
+    if (!nlohmann::json::sax_parse(body.data(), body.data() + body.size(), &extractor) || !extractor.sawList) {
+        return false;
+    }
+    snapshots.swap(found);
+    return true;
+}
+
+std::string WeatherSnapshot::encode() const {
+    std::string text = description ? description : "";
+    std::string out(encoded_fixed_size + text.size(), '\0');
+    std::memcpy(&out[0], snapshot_tag, sizeof(snapshot_tag));
+    writeField(out, 4, static_cast<int32_t>(cityId));
+    writeField(out, 8, static_cast<int32_t>(conditionId));
+    std::memcpy(&out[12], icon, sizeof(icon));
+    writeField(out, 16, temperature);
+    writeField(out, 24, static_cast<int32_t>(humidity));
+    writeField(out, 28, windSpeed);
+    writeField(out, 36, sunrise);
+    writeField(out, 44, sunset);
+    writeField(out, 52, static_cast<uint32_t>(text.size()));
+    std::memcpy(&out[encoded_fixed_size], text.data(), text.size());
+    return out;
+}
+
+bool WeatherSnapshot::decode(const std::string& bytes, WeatherSnapshot& snapshot) {
+    if (bytes.size() < encoded_fixed_size || std::memcmp(bytes.data(), snapshot_tag, sizeof(snapshot_tag)) != 0) {
+        return false;
+    }
+    const char* base = bytes.data();
+    uint32_t textSize = readField<uint32_t>(base, 52);
+    if (textSize != bytes.size() - encoded_fixed_size) {
+        return false;
+    }
+    WeatherSnapshot decoded = {};
+    decoded.valid = true;
+    decoded.cityId = readField<int32_t>(base, 4);
+    decoded.conditionId = readField<int32_t>(base, 8);
+    std::memcpy(decoded.icon, base + 12, sizeof(decoded.icon));
+    decoded.icon[sizeof(decoded.icon) - 1] = '\0';
+    decoded.temperature = readField<double>(base, 16);
+    decoded.humidity = readField<int32_t>(base, 24);
+    decoded.windSpeed = readField<double>(base, 28);
+    decoded.sunrise = readField<int64_t>(base, 36);
+    decoded.sunset = readField<int64_t>(base, 44);
+    decoded.description = internWeatherText(bytes.substr(encoded_fixed_size));
+    formatLocalTime(decoded.sunrise, decoded.sunriseText);
+    formatLocalTime(decoded.sunset, decoded.sunsetText);
+    snapshot = decoded;
+    return true;
+}
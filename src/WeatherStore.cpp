@@ -0,0 +1,180 @@
+#include "WeatherStore.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+namespace {
+
+const char store_magic[4] = { 'M', 'W', 'S', 'T' };
+const uint32_t store_version = 2; // 2: bodies are encoded WeatherSnapshots, not JSON
+const size_t header_size = 16;                 // magic, version, slot size, reserved
+const size_t slot_header_size = 40;            // checksum, body length, fetchedAt, key
+const size_t key_capacity = 24;
+const size_t body_capacity = WeatherStore::slot_size - slot_header_size;
+
+// FNV-1a: Cheap checksum that is good enough to spot a slot that was only partly written
+uint32_t checksum(const char* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+}
+
+WeatherStore::WeatherStore(const std::string& path, size_t capacity, std::chrono::seconds maxAge)
+    : path(path), capacity(capacity), maxAge(maxAge), slotsInFile(0) {
+}
+
+// Function to Load the Store: validate every slot of the mapped file and index the ones worth keeping
+std::vector<WeatherStore::Record> WeatherStore::load() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Record> records;
+    index.clear();
+    freeSlots.clear();
+    slotsInFile = 0;
+
+    MappedFile mapped;
+    bool valid = mapped.open(path) && mapped.size() >= header_size
+        && std::memcmp(mapped.data(), store_magic, sizeof(store_magic)) == 0;
+    if (valid) {
+        uint32_t version, slotSize;
+        std::memcpy(&version, mapped.data() + 4, sizeof(version));
+        std::memcpy(&slotSize, mapped.data() + 8, sizeof(slotSize));
+        valid = version == store_version && slotSize == slot_size;
+    }
+    if (!valid) {
+        mapped.close();
+        resetFile();
+        return records;
+    }
+
+    int64_t oldestAllowed = static_cast<int64_t>(std::time(nullptr)) - maxAge.count();
+    // A trailing partial slot (torn append) is ignored and later overwritten
+    slotsInFile = static_cast<uint32_t>((mapped.size() - header_size) / slot_size);
+    for (uint32_t slot = 0; slot < slotsInFile; slot++) {
+        const char* base = mapped.data() + header_size + static_cast<size_t>(slot) * slot_size;
+        uint32_t storedChecksum, bodyLength;
+        int64_t fetchedAt;
+        std::memcpy(&storedChecksum, base, sizeof(storedChecksum));
+        std::memcpy(&bodyLength, base + 4, sizeof(bodyLength));
+        std::memcpy(&fetchedAt, base + 8, sizeof(fetchedAt));
+
+        bool intact = bodyLength > 0 && bodyLength <= body_capacity
+            && checksum(base + 4, slot_header_size - 4 + bodyLength) == storedChecksum;
+        if (!intact || fetchedAt < oldestAllowed || slot >= capacity) {
+            freeSlots.push_back(slot); // Torn, empty or expired
+            continue;
+        }
+
+        Record record;
+        record.key.assign(base + 16, std::find(base + 16, base + 16 + key_capacity, '\0'));
+        record.body.assign(base + slot_header_size, bodyLength);
+        record.fetchedAt = fetchedAt;
+
+        // A key should only occupy one slot; if a damaged file has it twice, keep the newest copy
+        auto existing = index.find(record.key);
+        if (existing != index.end()) {
+            if (existing->second.fetchedAt >= fetchedAt) {
+                freeSlots.push_back(slot);
+                continue;
+            }
+            freeSlots.push_back(existing->second.slot);
+        }
+        index[record.key] = { slot, fetchedAt };
+        records.push_back(record);
+    }
+    mapped.close();
+
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    return records;
+}
+
+// Function to Persist One Response; responses too large for a slot are simply not persisted
+bool WeatherStore::save(const std::string& key, const std::string& body, int64_t fetchedAt) {
+    if (key.empty() || key.size() >= key_capacity || body.empty() || body.size() > body_capacity) {
+        return false;
+    }
+
+    char buffer[slot_size];
+    std::memset(buffer, 0, sizeof(buffer));
+    uint32_t bodyLength = static_cast<uint32_t>(body.size());
+    std::memcpy(buffer + 4, &bodyLength, sizeof(bodyLength));
+    std::memcpy(buffer + 8, &fetchedAt, sizeof(fetchedAt));
+    std::memcpy(buffer + 16, key.data(), key.size());
+    std::memcpy(buffer + slot_header_size, body.data(), body.size());
+    uint32_t sum = checksum(buffer + 4, slot_header_size - 4 + body.size());
+    std::memcpy(buffer, &sum, sizeof(sum));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open()) {
+        return false;
+    }
+    uint32_t slot = chooseSlot(key);
+    file.seekp(static_cast<std::streamoff>(header_size + static_cast<size_t>(slot) * slot_size));
+    file.write(buffer, sizeof(buffer));
+    file.flush();
+    if (!file) {
+        file.clear();
+        return false;
+    }
+    if (slot >= slotsInFile) {
+        slotsInFile = slot + 1;
+    }
+    index[key] = { slot, fetchedAt };
+    return true;
+}
+
+// Function to Start an Empty Store File, used when it is missing or from an older format
+bool WeatherStore::resetFile() {
+    if (file.is_open()) {
+        file.close();
+    }
+    char header[header_size];
+    std::memset(header, 0, sizeof(header));
+    std::memcpy(header, store_magic, sizeof(store_magic));
+    uint32_t slotSize = slot_size;
+    std::memcpy(header + 4, &store_version, sizeof(store_version));
+    std::memcpy(header + 8, &slotSize, sizeof(slotSize));
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(header, sizeof(header));
+        if (!out) {
+            std::cerr << "Unable to create weather store: " << path << std::endl;
+            return false;
+        }
+    }
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    return file.is_open();
+}
+
+// Function to Pick the Slot for a Key: its current slot, a free slot, a new slot, or the oldest one
+uint32_t WeatherStore::chooseSlot(const std::string& key) {
+    auto it = index.find(key);
+    if (it != index.end()) {
+        return it->second.slot;
+    }
+    while (!freeSlots.empty()) {
+        uint32_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        if (slot < capacity) {
+            return slot;
+        }
+    }
+    if (slotsInFile < capacity) {
+        return slotsInFile;
+    }
+    auto oldest = index.begin();
+    for (auto candidate = index.begin(); candidate != index.end(); ++candidate) {
+        if (candidate->second.fetchedAt < oldest->second.fetchedAt) {
+            oldest = candidate;
+        }
+    }
+    uint32_t slot = oldest->second.slot;
+    index.erase(oldest);
+    return slot;
+}
@@ -0,0 +1,59 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(size_t maxWorkers)
+    : workerCap(maxWorkers > 0 ? maxWorkers : 1), workersAlive(0), workersIdle(0), stopping(false) {
+}
+
+// Stop accepting work, drop queued jobs and wait for running ones to finish
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobAvailable.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+// Function to Queue a Job, starting a new worker only if none is idle and the cap allows it
+void WorkerPool::submit(std::function<void()> job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping) {
+        return;
+    }
+    jobs.push_back(std::move(job));
+    if (workersIdle == 0 && workersAlive < workerCap) {
+        workersAlive++;
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+    else {
+        jobAvailable.notify_one();
+    }
+}
+
+size_t WorkerPool::maxWorkers() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return workerCap;
+}
+
+// Worker Loop: Pop jobs until the pool stops
+void WorkerPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        workersIdle++;
+        jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+        workersIdle--;
+        if (stopping) {
+            return;
+        }
+        std::function<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
@@ -1,22 +1,31 @@
 #include "MusaWeatherApp.h"
-#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include "FileUtils.h"
+#include <cstdio>
+#include <cstdlib>
 #include <map>  // Include map to store icons
 
-int main(int, char**) {
+// Function to Open the Window, Initialize ImGui and Start Background Loading, timing each phase;
+// null if GLFW or the window could not be created
+GLFWwindow* startUp(StartupProfiler& profiler, bool visible) {
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
-        return -1;
+        return nullptr;
     }
+    profiler.mark("glfwInit");
 
+    if (!visible) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // --startup-benchmark runs without showing a window
+    }
     GLFWwindow* window = glfwCreateWindow(1280, 720, "Musa's Weather Channel", NULL, NULL);
     if (window == NULL) {
         std::cerr << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
-        return -1;
+        return nullptr;
     }
     glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);
+    glfwSwapInterval(visible ? 1 : 0);
+    profiler.mark("create window");
 
     // Load and set the window icon
     int iconWidth, iconHeight, iconChannels;
@@ -32,6 +41,7 @@ int main(int, char**) {
     else {
         std::cerr << "Failed to load icon image" << std::endl;
     }
+    profiler.mark("window icon");
 
     // Initialize ImGui context
     IMGUI_CHECKVERSION();
@@ -49,95 +59,210 @@ int main(int, char**) {
     // Setup ImGui binding for GLFW and OpenGL
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 130");
+    profiler.mark("ImGui init");
 
     // Read API key from file
     api_key = readApiKeyFromFile("assets/key.txt");
+    profiler.mark("read API key");
+    loadPersistedWeather(); // Last-known weather from the previous run, served stale until refreshed
+    profiler.mark("load persisted weather");
+    geocodeMisses.load(geocode_miss_file); // Before favorites are resolved, so known-bad names skip the API
+    profiler.mark("load geocode misses");
+    // Checking a large index takes a while. Queued lookups (favorites resolved at startup) wait for it;
+    // it is the first job on lookupPool, so lookups queued there behind it cannot hold it up.
+    gazetteer.openPending();
+    profiler.runInBackground(lookupPool, "open gazetteer", []() {
+        if (!gazetteer.open(gazetteer_file)) {
+            std::cerr << "No offline gazetteer at " << gazetteer_file << "; place names are looked up online" << std::endl;
+        }
+        });
+    // Weather icons are decoded and packed into one atlas off the UI thread; the texture is created once it is ready
+    profiler.runInBackground(lookupPool, "decode icon atlas", []() {
+        if (!iconAtlas.build(weatherIconSources(), weather_icon_size)) {
+            std::cerr << "Failed to load weather icons" << std::endl;
+        }
+        });
+    return window;
+}
+
+// Function to Release the GL Resources, ImGui and the Window
+void shutDown(GLFWwindow* window) {
+    iconAtlas.release();
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
+
+// Function to Move the Favorites and Saved State Aside and write `count` favorites that have only a
+// name, as an old favorites.txt would, so every one of them needs a lookup at startup
+bool writeUnresolvedFavorites(int count) {
+    const std::string files[] = { favorites_file, favorites_journal_file, app_state_file };
+    for (const auto& file : files) {
+        std::ifstream existing(file);
+        if (existing.is_open() && std::rename(file.c_str(), (file + ".benchmark-backup").c_str()) != 0) {
+            std::cerr << "Failed to move " << file << " aside" << std::endl;
+            return false;
+        }
+    }
+    std::string lines;
+    for (int i = 0; i < count; i++) {
+        lines += "Startup Benchmark Place " + std::to_string(i + 1) + "\n";
+    }
+    return writeFileAtomically(favorites_file, lines);
+}
+
+// Function to Put Back the Files writeUnresolvedFavorites Moved Aside
+void restoreFavorites() {
+    const std::string files[] = { favorites_file, favorites_journal_file, app_state_file };
+    for (const auto& file : files) {
+        std::remove(file.c_str());
+        std::ifstream backup(file + ".benchmark-backup");
+        if (backup.is_open()) {
+            backup.close();
+            if (std::rename((file + ".benchmark-backup").c_str(), file.c_str()) != 0) {
+                std::cerr << "Failed to restore " << file << " from " << file << ".benchmark-backup" << std::endl;
+            }
+        }
+    }
+}
+
+// Function to Run Startup `runs` Times with a Hidden Window and Report Percentiles of each phase,
+// so regressions in time-to-first-frame show up. Favorites lookups are cancelled and background
+// loading is waited for after each run so the runs do not overlap. With `unresolvedFavorites`, the
+// runs start from that many name-only favorites instead of the user's files, which are restored after.
+int runStartupBenchmark(int runs, int unresolvedFavorites) {
+    if (unresolvedFavorites > 0 && !writeUnresolvedFavorites(unresolvedFavorites)) {
+        restoreFavorites();
+        return -1;
+    }
+    const std::vector<City> builtInCities(cities.begin(), cities.end());
+    std::vector<std::vector<StartupProfiler::Phase>> profiles;
+    for (int run = 0; run < runs; run++) {
+        cities.clear();
+        for (const auto& city : builtInCities) {
+            cities.add(city);
+        }
+        StartupProfiler profiler;
+        GLFWwindow* window = startUp(profiler, false);
+        if (window == nullptr) {
+            break;
+        }
+        std::set<std::string> favorites;
+        std::map<std::string, bool> selectedFavorites;
+        std::map<std::string, GeocodeJob> favoriteLookups = loadAppState(favorites, selectedFavorites);
+        profiler.mark("load app state");
+
+        // An empty frame: creating the font texture and shaders dominates the first one
+        glfwPollEvents();
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+        ImGui::Begin("Musa's Weather Channel");
+        ImGui::End();
+        ImGui::Render();
+        glClear(GL_COLOR_BUFFER_BIT);
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        glfwSwapBuffers(window);
+        profiler.mark("first frame");
+
+        for (auto& lookup : favoriteLookups) {
+            lookup.second->cancel(cancelPool);
+        }
+        profiler.waitForBackground();
+        shutDown(window);
+        profiles.push_back(profiler.phases());
+    }
+    if (unresolvedFavorites > 0) {
+        restoreFavorites();
+    }
+    if (profiles.size() < static_cast<size_t>(runs)) {
+        return -1;
+    }
+
+    nlohmann::json summary = StartupProfiler::summarize(profiles);
+    StartupProfiler::reportSummary(summary, std::cout);
+    if (!writeFileAtomically(startup_benchmark_file, summary.dump(2))) {
+        std::cerr << "Failed to write " << startup_benchmark_file << std::endl;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int benchmarkRuns = 0;
+    int unresolvedFavorites = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--startup-benchmark") {
+            int runs = i + 1 < argc ? std::atoi(argv[i + 1]) : 0;
+            benchmarkRuns = runs > 0 ? runs : default_startup_benchmark_runs;
+        }
+        else if (arg == "--unresolved-favorites" && i + 1 < argc) {
+            unresolvedFavorites = std::atoi(argv[++i]);
+        }
+    }
+    if (benchmarkRuns > 0) {
+        return runStartupBenchmark(benchmarkRuns, unresolvedFavorites);
+    }
+
+    StartupProfiler profiler; // Reported once the first frame is up and background loading has finished
+    bool firstFrameShown = false;
+    bool startupReported = false;
+    GLFWwindow* window = startUp(profiler, true);
+    if (window == nullptr) {
+        return -1;
+    }
 
     // Variables to manage application state
     bool showWeatherPopup = false;
     bool showAddPlacePopup = false;
     bool showWarningPopup = false;
     bool showNoSelectionPopup = false;
-    std::vector<std::thread> threads;
+    std::shared_ptr<WeatherBatch> weatherBatch; // Fetches started by the last "See Weather" click
+    std::chrono::steady_clock::time_point batchStarted;
+    double lastBatchSeconds = 0.0; // Time from "See Weather" until every requested city had data
     std::set<std::string> favorites;
     std::map<std::string, bool> selectedFavorites; // Map to track selection in My List
-    loadMyCityList(cities, favorites); // Load favorite cities from file
+    // Restore the last session (or the built-in cities plus favorites.txt); favorites without a saved
+    // location are resolved in the background
+    std::map<std::string, GeocodeJob> favoriteLookups = loadAppState(favorites, selectedFavorites);
+    profiler.mark("load app state");
+    std::chrono::steady_clock::time_point lastStateSave = std::chrono::steady_clock::now();
     char cityNameBuffer[128] = ""; // Buffer for new city input
     char addCityBuffer[128] = "";  // Buffer for the "Add Place" popup
     bool selectAllCities = false;
     bool selectAllFavorites = false;
-
-    // Load weather icons only once and reuse them
-    std::map<std::string, GLuint> weatherIcons;
-    const std::map<std::string, std::string> weatherIconPaths = {
-        {"Clear", "assets/sunny.png"},
-        {"Clouds", "assets/cloudy.png"},
-        {"Rain", "assets/rainy.png"}
-    };
-
-    auto loadIcon = [&](const std::string& iconPath) -> GLuint {
-        int width, height, channels;
-        unsigned char* data = stbi_load(iconPath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
-        if (data) {
-            GLuint textureID;
-            glGenTextures(1, &textureID);
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            stbi_image_free(data);
-            return textureID;
-        }
-        return 0;
-        };
-
-    for (const auto& icon : weatherIconPaths) {
-        GLuint iconID = loadIcon(icon.second);
-        if (iconID != 0) {
-            weatherIcons[icon.first] = iconID;
-        }
-        else {
-            std::cerr << "Failed to load icon: " << icon.second << std::endl;
+    std::vector<City*> shownCities; // First column: the cities not in My List, rebuilt when either list changes
+    uint64_t shownForCities = 0;
+    uint64_t favoritesRevision = 1; // Bumped whenever `favorites` changes
+    uint64_t shownForFavorites = 0;
+
+    // Background lookups; the frame loop polls them so the UI keeps rendering during the round trip
+    GeocodeJob addPlaceJob;     // "Add Place" popup
+    GeocodeJob randomCityJob;   // "Add Random City" button
+    std::string addPlaceError;  // Shown in the popup when the last lookup found nothing or got no answer
+    std::mt19937 randomEngine(std::random_device{}()); // Offline random-city sampling
+    std::vector<Gazetteer::Place> placeSuggestions; // Typeahead for the "Add Place" input
+    std::string suggestionsFor;
+    bool suggestionsFuzzy = false;
+
+    // Function to add the city found near a random coordinate (UI thread)
+    auto addRandomCity = [&](const GeocodeResult& place) { // lambda function
+        if (!place.found) {
+            std::cerr << "No city found at the random coordinates." << std::endl;
+            return;
         }
-    }
 
-    // Function to add a random city using the weather API
-    auto addRandomCity = [&]() { // lambda function
-        // Generate random latitude and longitude
-        double randomLat = (static_cast<double>(rand()) / RAND_MAX) * 180.0 - 90.0;  // Latitude between -90 and 90
-        double randomLon = (static_cast<double>(rand()) / RAND_MAX) * 360.0 - 180.0; // Longitude between -180 and 180
-
-        // Use the OpenWeatherMap API to get a city near these random coordinates
-        httplib::Client cli("http://api.openweathermap.org");
-        std::string url = "/geo/1.0/reverse?lat=" + std::to_string(randomLat) + "&lon=" + std::to_string(randomLon) + "&limit=1&appid=" + api_key;
-
-        auto res = cli.Get(url.c_str());
-        if (res && res->status == 200) {
-            auto cityList = nlohmann::json::parse(res->body);
-            if (!cityList.empty()) {
-                std::string cityName = cityList[0]["name"];
-                double lon = cityList[0]["lon"];
-                double lat = cityList[0]["lat"];
-
-                // Check if the city is already in the main list or My List
-                bool cityExists = std::any_of(cities.begin(), cities.end(), [&](const City& c) {
-                    return c.name == cityName;
-                    }) || favorites.find(cityName) != favorites.end();
-
-                // If the city is unique, add it to the list
-                if (!cityExists) {
-                    cities.push_back({ cityName, lon, lat, false, nullptr });
-                }
-                else {
-                    std::cerr << "City " << cityName << " is already in the list." << std::endl;
-                }
-            }
-            else {
-                std::cerr << "No city found at the random coordinates." << std::endl;
-            }
+        // Check if the city is already in the main list or My List
+        bool cityExists = cities.find(place.name) != nullptr || favorites.find(place.name) != favorites.end();
+
+        // If the city is unique, add it to the list
+        if (!cityExists) {
+            cities.add({ place.name, place.lon, place.lat, false });
         }
         else {
-            std::cerr << "Failed to fetch random city from API" << std::endl;
+            std::cerr << "City " << place.name << " is already in the list." << std::endl;
         }
         };
 
@@ -150,6 +275,28 @@ int main(int, char**) {
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
+        // Apply weather that fetch jobs delivered since the last frame, then finished lookups; fetch
+        // jobs hold handles, so cities can be added and removed while a batch is running
+        cities.collectWeather();
+        if (randomCityJob && randomCityJob->ready()) {
+            if (randomCityJob->failed()) {
+                std::cerr << randomCityJob->error() << std::endl;
+            }
+            else {
+                addRandomCity(randomCityJob->result());
+            }
+            randomCityJob.reset();
+        }
+
+        if (applyFavoriteLookups(favoriteLookups, cities, favorites, selectedFavorites)) {
+            favoritesRevision++;
+        }
+
+        if (std::chrono::steady_clock::now() - lastStateSave > std::chrono::seconds(app_state_save_interval_seconds)) {
+            saveAppState(favorites, selectedFavorites, false);
+            lastStateSave = std::chrono::steady_clock::now();
+        }
+
         // Retrieve the size of the GLFW window
         int display_w, display_h;
         glfwGetFramebufferSize(window, &display_w, &display_h);
@@ -163,6 +310,10 @@ int main(int, char**) {
 
         // Header: Application title with padding
         ImGui::Text("Enjoy exploring the weather !!");
+        RateLimiter::Stats quota = apiRateLimiter.stats();
+        ImGui::SameLine();
+        ImGui::TextDisabled("API quota: %zu / %.0f calls in the last minute, %.1f ready now, %zu in flight (limit %d), %zu throttled",
+            quota.callsLastMinute, quota.callsPerMinute, quota.tokens, quota.inFlight, static_cast<int>(quota.concurrencyLimit), quota.throttled);
         ImGui::Separator();
 
         // Layout: 3 Columns with padding
@@ -178,8 +329,21 @@ int main(int, char**) {
             }
         }
         ImGui::BeginChild("City Selection", ImVec2(0, display_h * 0.7f), true);  // Limit height to avoid scrolling
-        for (auto& city : cities) {
-            if (favorites.find(city.name) == favorites.end()) {  // Only show cities not in My List
+        if (shownForCities != cities.revision() || shownForFavorites != favoritesRevision) {
+            shownCities.clear();
+            for (auto& city : cities) {
+                if (favorites.find(city.name) == favorites.end()) {  // Only show cities not in My List
+                    shownCities.push_back(&city);
+                }
+            }
+            shownForCities = cities.revision();
+            shownForFavorites = favoritesRevision;
+        }
+        ImGuiListClipper cityClipper; // Only the rows in view are drawn, so 100k cities cost little per frame
+        cityClipper.Begin(static_cast<int>(shownCities.size()));
+        while (cityClipper.Step()) {
+            for (int row = cityClipper.DisplayStart; row < cityClipper.DisplayEnd; row++) {
+                City& city = *shownCities[row];
                 ImGui::Checkbox(city.name.c_str(), &city.selected);
                 ImGui::SameLine();
                 ImGui::TextColored(ImVec4(0.4f, 0.7f, 1.0f, 1.0f), city.selected ? "Selected" : " ");
@@ -196,21 +360,37 @@ int main(int, char**) {
             }
         }
         ImGui::BeginChild("My List", ImVec2(0, display_h * 0.7f), true);  // Limit height to avoid scrolling
-        for (std::set<std::string>::iterator it = favorites.begin(); it != favorites.end(); ++it) {
-            bool selected = selectedFavorites[*it]; // Track selection state in the map
-            if (ImGui::Checkbox(it->c_str(), &selected)) {
-                selectedFavorites[*it] = selected; // Update the selection state
-                if (selected) {
-                    auto itCity = std::find_if(cities.begin(), cities.end(), [&](City& city) {
-                        return city.name == *it;
-                        });
-                    if (itCity == cities.end()) {
-                        cities.push_back({ *it, 0.0, 0.0, true, nullptr });
+        ImGuiListClipper favoriteClipper;
+        favoriteClipper.Begin(static_cast<int>(favorites.size()));
+        std::set<std::string>::iterator it = favorites.begin();
+        int favoriteRow = 0;
+        while (favoriteClipper.Step()) {
+            for (; favoriteRow < favoriteClipper.DisplayStart; favoriteRow++) {
+                ++it; // Rows above the view
+            }
+            for (; favoriteRow < favoriteClipper.DisplayEnd; favoriteRow++, ++it) {
+                if (favoriteLookups.find(*it) != favoriteLookups.end()) {
+                    // Location still being looked up; the row fills in when the result arrives
+                    ImGui::BeginDisabled();
+                    bool unresolved = false;
+                    ImGui::Checkbox(it->c_str(), &unresolved);
+                    ImGui::EndDisabled();
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("resolving...");
+                    continue;
+                }
+                bool selected = selectedFavorites[*it]; // Track selection state in the map
+                if (ImGui::Checkbox(it->c_str(), &selected)) {
+                    selectedFavorites[*it] = selected; // Update the selection state
+                    if (selected) {
+                        if (!cities.find(*it)) {
+                            cities.add({ *it, 0.0, 0.0, true });
+                        }
                     }
                 }
+                ImGui::SameLine();
+                ImGui::TextColored(ImVec4(0.4f, 0.7f, 1.0f, 1.0f), selectedFavorites[*it] ? "Selected" : " ");
             }
-            ImGui::SameLine();
-            ImGui::TextColored(ImVec4(0.4f, 0.7f, 1.0f, 1.0f), selectedFavorites[*it] ? "Selected" : " ");
         }
         ImGui::EndChild();
 
@@ -242,26 +422,29 @@ int main(int, char**) {
                 }
                 else {
                     showWeatherPopup = true;
-                    threadsFinished = 0;
+                    cancelWeatherBatch(weatherBatch); // A new batch replaces whatever is still running
+                    batchStarted = std::chrono::steady_clock::now();
+                    lastBatchSeconds = 0.0;
                     for (auto& city : cities) {
-                        city.weatherData = nullptr; // Clear previous weather data
+                        city.weatherData = WeatherSnapshot(); // Clear previous weather data
                     }
                     // Fetch weather for cities in both main list and My List
+                    std::vector<City*> targets;
                     for (auto& city : cities) {
-                        if (city.selected) {
-                            threads.emplace_back(getWeatherDataForEach, std::ref(city)); // Fetch weather data in separate threads
+                        if (city.selected && !city.geocodePending) {
+                            targets.push_back(&city);
                         }
                     }
                     for (auto& fav : favorites) {
                         if (selectedFavorites[fav]) {
-                            auto itCity = std::find_if(cities.begin(), cities.end(), [&](City& city) {
-                                return city.name == fav;
-                                });
-                            if (itCity != cities.end()) {
-                                threads.emplace_back(getWeatherDataForEach, std::ref(*itCity));
+                            City* city = cities.find(fav);
+                            if (city && !city->geocodePending) {
+                                targets.push_back(city);
                             }
                         }
                     }
+                    // Fresh cached data needs no request; stale data is shown now and refreshed in the background
+                    weatherBatch = startWeatherBatch(targets);
                     uncheckAllCities(cities); // Uncheck all cities after fetching data
                     for (auto& fav : selectedFavorites) {
                         fav.second = false; // Uncheck all cities in My List after fetching data
@@ -275,21 +458,18 @@ int main(int, char**) {
         ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.3f, 0.9f, 0.5f, 1.0f));
         ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.1f, 0.7f, 0.3f, 1.0f));
         if (ImGui::Button("Add to My List", buttonSize)) {
-            std::vector<City> toRemove;
+            // The city stays in `cities` (hidden from the first column) so its location is saved with it
+            std::vector<const City*> added;
             for (auto& city : cities) {
                 if (city.selected && favorites.find(city.name) == favorites.end()) {
                     favorites.insert(city.name);
-                    toRemove.push_back(city);
+                    favoritesRevision++;
                     selectedFavorites[city.name] = false; // Initialize the selection state for My List
+                    cancelCityRequests(weatherBatch, city.handle); // Its fetch from the main list is abandoned, as on delete
+                    added.push_back(&city);
                 }
             }
-            // Remove cities added to My List from the main city list
-            for (auto& city : toRemove) {
-                cities.erase(std::remove_if(cities.begin(), cities.end(), [&](const City& c) {
-                    return c.name == city.name;
-                    }), cities.end());
-            }
-            saveMyCityList(favorites);
+            journalFavorites(added, std::vector<std::string>(), cities, favorites);
             uncheckAllCities(cities);
         }
         ImGui::PopStyleColor(3);
@@ -308,15 +488,14 @@ int main(int, char**) {
             // Remove cities from My List and add back to main city list
             for (std::vector<std::string>::iterator it = toRemove.begin(); it != toRemove.end(); ++it) {
                 favorites.erase(*it);
+                favoritesRevision++;
                 // Check if city is already in the main list before adding
-                if (std::find_if(cities.begin(), cities.end(), [&](const City& city) {
-                    return city.name == *it;
-                    }) == cities.end()) {
-                    cities.push_back({ *it, 0.0, 0.0, false, nullptr });  // Re-add to main city list
+                if (!cities.find(*it)) {
+                    cities.add({ *it, 0.0, 0.0, false });  // Re-add to main city list
                 }
                 selectedFavorites.erase(*it); // Remove from the selection state map
             }
-            saveMyCityList(favorites);
+            journalFavorites(std::vector<const City*>(), toRemove, cities, favorites);
         }
         ImGui::PopStyleColor(3);
         ImGui::Dummy(ImVec2(0.0f, buttonSpacing));  // Add spacing
@@ -327,6 +506,7 @@ int main(int, char**) {
         if (ImGui::Button("Add Place", buttonSize)) {
             showAddPlacePopup = true;
             strcpy(addCityBuffer, ""); // Clear buffer
+            addPlaceError.clear();
         }
         ImGui::PopStyleColor(3);
         ImGui::Dummy(ImVec2(0.0f, buttonSpacing));  // Add spacing
@@ -334,9 +514,27 @@ int main(int, char**) {
         ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.7f, 0.4f, 0.8f, 1.0f));  // Purple
         ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.8f, 0.5f, 0.9f, 1.0f));
         ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.6f, 0.3f, 0.7f, 1.0f));
-        if (ImGui::Button("Add Random City", buttonSize)) {
-            addRandomCity();
+        ImGui::BeginDisabled(randomCityJob != nullptr);
+        if (ImGui::Button(randomCityJob ? "Finding a City...###AddRandomCity" : "Add Random City###AddRandomCity", buttonSize)) {
+            if (gazetteer.isOpen()) {
+                // Offline: a few draws to find a populated place that is not listed yet
+                GeocodeResult place = { false, "", 0.0, 0.0 };
+                for (int attempt = 0; attempt < 32 && randomGazetteerPlace(randomEngine, place); attempt++) {
+                    bool listed = favorites.find(place.name) != favorites.end() || cities.find(place.name) != nullptr;
+                    if (!listed) {
+                        break;
+                    }
+                }
+                randomCityJob = AsyncJob<GeocodeResult>::completed(place);
+            }
+            else {
+                // Generate random latitude and longitude
+                double randomLat = (static_cast<double>(rand()) / RAND_MAX) * 180.0 - 90.0;  // Latitude between -90 and 90
+                double randomLon = (static_cast<double>(rand()) / RAND_MAX) * 360.0 - 180.0; // Longitude between -180 and 180
+                randomCityJob = startReverseLookup(randomLat, randomLon);
+            }
         }
+        ImGui::EndDisabled();
         ImGui::PopStyleColor(3);
         ImGui::Dummy(ImVec2(0.0f, buttonSpacing));  // Add spacing
 
@@ -344,7 +542,7 @@ int main(int, char**) {
         ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.9f, 0.3f, 0.3f, 1.0f));
         ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.5f, 0.0f, 0.0f, 1.0f));
         if (ImGui::Button("Delete City", buttonSize)) {
-            std::vector<std::string> toDelete;
+            std::vector<CityHandle> toDelete;
             bool canDelete = true;
             for (auto& city : cities) {
                 if (city.selected) {
@@ -352,14 +550,13 @@ int main(int, char**) {
                         canDelete = false; // Found a city in MyList that cannot be deleted
                         break;
                     }
-                    toDelete.push_back(city.name);
+                    toDelete.push_back(city.handle);
                 }
             }
             if (canDelete) {
-                for (auto& cityName : toDelete) {
-                    cities.erase(std::remove_if(cities.begin(), cities.end(), [&](const City& city) {
-                        return city.name == cityName;
-                        }), cities.end());
+                for (const CityHandle& handle : toDelete) {
+                    cancelCityRequests(weatherBatch, handle); // Deleted cities must not keep requests running
+                    cities.remove(handle);
                 }
             }
             else {
@@ -368,46 +565,58 @@ int main(int, char**) {
         }
         ImGui::PopStyleColor(3);
 
-        // Handle fetching weather data in background threads
+        // Open the weather popup right away; it fills in as the batch finishes
         if (showWeatherPopup) {
-            if (threadsFinished == threads.size()) {
-                for (auto& thread : threads) {
-                    if (thread.joinable()) {
-                        thread.join(); // Wait for all threads to finish
-                    }
-                }
-                threads.clear();
-                showWeatherPopup = false;
-
-                // Show a popup window with the weather data
-                ImGui::OpenPopup("Weather Data");
-            }
+            showWeatherPopup = false;
+            ImGui::OpenPopup("Weather Data");
+        }
+        if (weatherBatch && weatherBatch->done() && lastBatchSeconds == 0.0) {
+            lastBatchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStarted).count();
         }
 
         // Popup window to display weather data
         if (ImGui::BeginPopupModal("Weather Data", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+            if (weatherBatch && !weatherBatch->done()) {
+                ImGui::Text("Fetching weather... %d of %d requests done", weatherBatch->finished.load(), weatherBatch->queued.load());
+                ImGui::Separator();
+            }
             for (auto& city : cities) {
-                if (!city.weatherData.is_null()) {
-                    // Determine the weather icon based on the weather type
-                    const std::string& weatherType = city.weatherData["weather"][0]["main"].get<std::string>();
-                    GLuint weatherIcon = weatherIcons[weatherType];
-
-                    if (weatherIcon) {
-                        // Ensure all icons are displayed with the same size
-                        ImGui::Image((void*)(intptr_t)weatherIcon, ImVec2(64, 64));  // Fixed size of 64x64 pixels
+                if (city.weatherData.valid) {
+                    // Determine the weather icon from the icon code (day or night) of the response
+                    IconAtlas::Icon weatherIcon;
+                    if (iconAtlas.upload() && iconAtlas.find(weatherIconKey(city.weatherData), weatherIcon)) {
+                        // Ensure all icons are displayed with the same size; every icon samples the same atlas texture
+                        ImGui::Image((void*)(intptr_t)iconAtlas.texture(), ImVec2(64, 64),
+                            ImVec2(weatherIcon.u0, weatherIcon.v0), ImVec2(weatherIcon.u1, weatherIcon.v1));  // Fixed size of 64x64 pixels
                     }
 
                     ImGui::Text("%s:", city.name.c_str());
-                    ImGui::Text("Weather: %s", city.weatherData["weather"][0]["description"].get<std::string>().c_str());
-                    ImGui::Text("Temperature: %.2f°C", city.weatherData["main"]["temp"].get<double>() - 273.15);
-                    ImGui::Text("Humidity: %d%%", city.weatherData["main"]["humidity"].get<int>());
-                    ImGui::Text("Wind Speed: %.2f m/s", city.weatherData["wind"]["speed"].get<double>());
-                    ImGui::Text("Sunrise: %s", unixToHHMM(city.weatherData["sys"]["sunrise"].get<int>()).c_str());
-                    ImGui::Text("Sunset: %s", unixToHHMM(city.weatherData["sys"]["sunset"].get<int>()).c_str());
+                    const WeatherSnapshot& weather = city.weatherData;
+                    ImGui::Text("Weather: %s", weather.description);
+                    ImGui::Text("Temperature: %.2f°C", weather.temperature - 273.15);
+                    ImGui::Text("Humidity: %d%%", weather.humidity);
+                    ImGui::Text("Wind Speed: %.2f m/s", weather.windSpeed);
+                    ImGui::Text("Sunrise: %s", weather.sunriseText);
+                    ImGui::Text("Sunset: %s", weather.sunsetText);
                     ImGui::Separator();
                 }
             }
+            HttpClientPool::Stats connStats = apiClientPool.stats();
+            ImGui::TextDisabled("Connections: %zu opened for %zu requests (%.0f%% reused), pool size %zu",
+                connStats.connectionsOpened, connStats.requests, connStats.reuseRate() * 100.0, connStats.clientsCreated);
+            ImGui::TextDisabled("Duplicate requests coalesced: %zu", weatherFlights.coalesced());
+            ImGui::TextDisabled("Batch finished in %.2f s; request latency p50 %lld ms, p95 %lld ms, p99 %lld ms",
+                lastBatchSeconds, static_cast<long long>(apiLatency.percentile(50.0).count()),
+                static_cast<long long>(apiLatency.percentile(95.0).count()), static_cast<long long>(apiLatency.percentile(99.0).count()));
+            ImGui::TextDisabled("Attempts %zu, retries %zu, hedges sent %zu (won %zu, stopped %zu), deadlines exceeded %zu",
+                apiRequestStats.attempts.load(), apiRequestStats.retries.load(), apiRequestStats.hedgesSent.load(),
+                apiRequestStats.hedgesWon.load(), apiRequestStats.hedgesStopped.load(), apiRequestStats.deadlinesExceeded.load());
+            WeatherCache::Stats cacheStats = weatherCache.stats();
+            ImGui::TextDisabled("Cache: %zu fresh hits, %zu stale, %zu misses, %zu of %zu entries, %zu evicted (TTL %lld s)",
+                cacheStats.hits, cacheStats.stale, cacheStats.misses, cacheStats.entries, weather_cache_capacity, cacheStats.evicted,
+                static_cast<long long>(weatherCache.ttl().count()));
             if (ImGui::Button("Close", ImVec2(120, 0))) {
+                cancelWeatherBatch(weatherBatch); // Abort outstanding fetches and background refreshes
                 ImGui::CloseCurrentPopup();
             }
             ImGui::EndPopup();
@@ -448,17 +657,67 @@ int main(int, char**) {
         }
 
         if (ImGui::BeginPopupModal("Add New Place", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+            bool lookingUp = addPlaceJob != nullptr;
             ImGui::Text("Enter the name of the city to add:");
+            ImGui::BeginDisabled(lookingUp);
             ImGui::InputText("##AddCityName", addCityBuffer, sizeof(addCityBuffer));
+            if (suggestionsFor != addCityBuffer) {
+                suggestionsFor = addCityBuffer;
+                placeSuggestions = gazetteer.suggest(suggestionsFor, max_place_suggestions, &suggestionsFuzzy);
+            }
+            if (!placeSuggestions.empty()) {
+                ImGui::TextDisabled(suggestionsFuzzy ? "Did you mean:" : "Suggestions:");
+                for (size_t i = 0; i < placeSuggestions.size(); i++) {
+                    const Gazetteer::Place& place = placeSuggestions[i];
+                    std::string label = place.name + ", " + place.country + "##Suggestion" + std::to_string(i);
+                    if (ImGui::Selectable(label.c_str())) {
+                        // The picked place is already resolved; add it without a lookup
+                        GeocodeResult picked = { true, place.name, place.lon, place.lat };
+                        addPlaceJob = AsyncJob<GeocodeResult>::completed(picked);
+                    }
+                    ImGui::SameLine(ImGui::GetContentRegionAvail().x * 0.75f);
+                    ImGui::TextDisabled("pop. %u", place.population);
+                }
+            }
 
             if (ImGui::Button("Add", ImVec2(120, 0))) {
-                addNewPlace(addCityBuffer);
-                ImGui::CloseCurrentPopup();
+                addPlaceError.clear();
+                addPlaceJob = startCityLookup(addCityBuffer);
             }
+            ImGui::EndDisabled();
             ImGui::SameLine();
             if (ImGui::Button("Cancel", ImVec2(120, 0))) {
+                if (addPlaceJob) {
+                    addPlaceJob->cancel(cancelPool); // Abort the lookup; its result is dropped
+                    addPlaceJob.reset();
+                }
                 ImGui::CloseCurrentPopup();
             }
+
+            if (lookingUp) {
+                ImGui::Text("Looking up \"%s\"...", addCityBuffer);
+            }
+            else if (!addPlaceError.empty()) {
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", addPlaceError.c_str());
+            }
+
+            if (addPlaceJob && addPlaceJob->ready()) {
+                if (addPlaceJob->failed()) {
+                    // No answer (offline, timeout, quota): the place may well exist, so the typed name stays for a retry
+                    std::cerr << addPlaceJob->error() << std::endl;
+                    addPlaceError = "Lookup failed, try again";
+                }
+                else {
+                    addNewPlace(addPlaceJob->result());
+                    if (addPlaceJob->result().found) {
+                        ImGui::CloseCurrentPopup();
+                    }
+                    else {
+                        addPlaceError = "City not found: " + addPlaceJob->result().name;
+                    }
+                }
+                addPlaceJob.reset();
+            }
             ImGui::EndPopup();
         }
 
@@ -472,14 +731,43 @@ int main(int, char**) {
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
         glfwSwapBuffers(window); // Swap front and back buffers
+
+        if (!startupReported) {
+            if (!firstFrameShown) {
+                profiler.mark("first frame");
+                firstFrameShown = true;
+            }
+            if (profiler.pendingBackground() == 0) {
+                profiler.report(std::cout);
+                if (!writeFileAtomically(startup_profile_file, profiler.toJson().dump(2))) {
+                    std::cerr << "Failed to write " << startup_profile_file << std::endl;
+                }
+                startupReported = true;
+            }
+        }
+    }
+
+    // Abort requests still in flight, so the worker pools (destroyed before the globals their jobs use)
+    // do not keep the process waiting out a long batch on exit
+    cancelWeatherBatch(weatherBatch);
+    for (auto& lookup : favoriteLookups) {
+        lookup.second->cancel(cancelPool);
+    }
+    if (addPlaceJob) {
+        addPlaceJob->cancel(cancelPool);
+    }
+    if (randomCityJob) {
+        randomCityJob->cancel(cancelPool);
+    }
+
+    saveMyCityList(cities, favorites); // Compacts the journal and keeps city ids learned this session
+    saveAppState(favorites, selectedFavorites, true);
+    if (!geocodeMisses.save(geocode_miss_file)) {
+        std::cerr << "Failed to save " << geocode_miss_file << std::endl;
     }
 
     // Clean up and terminate the application
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    shutDown(window);
 
     return 0;
 }
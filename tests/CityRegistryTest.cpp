@@ -0,0 +1,241 @@
+// City Registry Test: Handles go stale when their city is removed, reused slots get a new generation,
+// results delivered for a removed city or under a cancelled token are never applied, and deliveries
+// from worker threads racing the UI thread's add / remove / collect land only on the city they were
+// meant for. The name index finds the first city of a name in display order through adds and removes.
+// CMake also builds this with ThreadSanitizer where the compiler supports it.
+// Usage: city_registry_test
+#include "CityRegistry.h"
+#include "TestCheck.h"
+#include <cstdio>
+#include <random>
+#include <thread>
+
+namespace {
+
+const int stress_workers = 4;
+const int stress_rounds = 20000;
+const size_t stress_min_deliveries = 100000; // Keep editing until the workers have raced this many deliveries
+
+// A result that names the city it was meant for, so a misdelivery shows up on the city
+WeatherSnapshot weatherFor(CityHandle handle) {
+    WeatherSnapshot data = {};
+    data.valid = true;
+    data.humidity = static_cast<int>(handle.index);
+    data.conditionId = static_cast<int>(handle.generation);
+    return data;
+}
+
+bool hasWeatherFor(const City& city) {
+    return city.weatherData.valid && city.weatherData.humidity == static_cast<int>(city.handle.index) &&
+        city.weatherData.conditionId == static_cast<int>(city.handle.generation);
+}
+
+void testStaleHandles() {
+    CityRegistry registry;
+    std::shared_ptr<CancellationToken> token = std::make_shared<CancellationToken>();
+    CityHandle london = registry.add(City("London", -0.1276, 51.5074));
+    CityHandle paris = registry.add(City("Paris", 2.3522, 48.8566));
+    expect(london.valid() && paris.valid() && london != paris, "add returns distinct valid handles");
+    expect(registry.get(london) && registry.get(london)->name == "London", "get finds a live city");
+    expect(registry.get(london)->handle == london, "the city carries its handle");
+
+    uint64_t revision = registry.revision();
+    expect(registry.remove(london), "remove succeeds once");
+    expect(registry.revision() != revision, "a remove changes the revision");
+    revision = registry.revision();
+    expect(!registry.remove(london), "remove of a stale handle fails");
+    expect(registry.revision() == revision, "a failed remove leaves the revision");
+    expect(registry.get(london) == nullptr, "get of a stale handle is null");
+    expect(!registry.deliverWeather(london, weatherFor(london), token), "delivery to a removed city is refused");
+    expect(registry.get(CityHandle()) == nullptr && !registry.deliverWeather(CityHandle(), weatherFor(paris), token),
+        "the empty handle names nothing");
+    expect(registry.size() == 1 && registry.begin()->name == "Paris", "the other city stays");
+
+    // Removed after delivery but before the UI thread collects it
+    expect(registry.deliverWeather(paris, weatherFor(paris), token), "delivery to a live city is accepted");
+    registry.remove(paris);
+    expect(registry.collectWeather() == 0, "a result parked for a city removed since is dropped");
+}
+
+void testSlotReuse() {
+    CityRegistry registry;
+    std::shared_ptr<CancellationToken> token = std::make_shared<CancellationToken>();
+    CityHandle first = registry.add(City("Tokyo", 139.6917, 35.6895));
+    registry.add(City("Seoul", 126.9780, 37.5665));
+    registry.remove(first);
+    CityHandle reused = registry.add(City("Lagos", 3.3792, 6.5244));
+    expect(reused.index == first.index, "a freed slot is reused");
+    expect(reused.generation != first.generation, "a reused slot gets a new generation");
+    expect(registry.get(first) == nullptr, "the old handle does not reach the city now in its slot");
+    expect(!registry.deliverWeather(first, weatherFor(first), token), "delivery through the old handle is refused");
+    expect(registry.collectWeather() == 0 && !registry.get(reused)->weatherData.valid, "the new city gets nothing meant for the old one");
+
+    expect(registry.deliverWeather(reused, weatherFor(reused), token), "delivery through the new handle is accepted");
+    expect(registry.collectWeather() == 1 && hasWeatherFor(*registry.get(reused)), "the new city gets its own result");
+
+    // Display order: appended at the end even though the slot is an old one
+    const char* order[] = { "Seoul", "Lagos" };
+    size_t i = 0;
+    for (const auto& city : registry) {
+        expect(i < 2 && city.name == order[i], "iteration follows the order cities were added");
+        i++;
+    }
+    expect(i == 2, "iteration visits every live city once");
+}
+
+void testCancelledTokens() {
+    CityRegistry registry;
+    CityHandle rome = registry.add(City("Rome", 12.4964, 41.9028));
+    std::shared_ptr<CancellationToken> cancelled = std::make_shared<CancellationToken>();
+    cancelled->cancel();
+    expect(!registry.deliverWeather(rome, weatherFor(rome), cancelled), "delivery under a cancelled token is refused");
+    expect(registry.collectWeather() == 0, "nothing is collected after a refused delivery");
+
+    // Cancelled after delivery, before the UI thread collects it
+    std::shared_ptr<CancellationToken> batch = std::make_shared<CancellationToken>();
+    expect(registry.deliverWeather(rome, weatherFor(rome), batch), "delivery under a live token is accepted");
+    batch->cancel();
+    expect(registry.collectWeather() == 0 && !registry.get(rome)->weatherData.valid, "a result whose batch was cancelled since is dropped");
+
+    // A late result from a cancelled batch must not replace the one parked by the batch that replaced it
+    std::shared_ptr<CancellationToken> newer = std::make_shared<CancellationToken>();
+    WeatherSnapshot fresh = weatherFor(rome);
+    fresh.cityId = 3169070;
+    expect(registry.deliverWeather(rome, fresh, newer), "the newer batch delivers");
+    WeatherSnapshot late = weatherFor(rome);
+    late.temperature = 1.0;
+    expect(!registry.deliverWeather(rome, late, cancelled), "the cancelled batch's late result is refused");
+    expect(registry.collectWeather() == 1, "the newer result is applied");
+    const City* city = registry.get(rome);
+    expect(city->weatherData.temperature == 0.0 && city->owmId == 3169070, "the newer result and its city id are kept");
+
+    // A second delivery before a collect replaces the first; the slot is collected once
+    WeatherSnapshot second = weatherFor(rome);
+    second.temperature = 2.0;
+    registry.deliverWeather(rome, weatherFor(rome), newer);
+    registry.deliverWeather(rome, second, newer);
+    expect(registry.collectWeather() == 1 && registry.get(rome)->weatherData.temperature == 2.0, "the last delivery wins");
+}
+
+// Names repeat (the built-in list has two "Buenos Aires"); find() returns the first in display order
+void testDuplicateNames() {
+    CityRegistry registry;
+    CityHandle first = registry.add(City("Buenos Aires", -58.3816, -34.6037));
+    CityHandle madrid = registry.add(City("Madrid", -3.7038, 40.4168));
+    CityHandle second = registry.add(City("Buenos Aires", -58.0, -34.0));
+    CityHandle third = registry.add(City("Buenos Aires", -57.0, -33.0));
+    expect(registry.find("Madrid") && registry.find("Madrid")->handle == madrid, "find returns the city with a unique name");
+    expect(registry.find("Buenos Aires")->handle == first, "find returns the first of a repeated name");
+    expect(registry.find("Lima") == nullptr, "find of an absent name is null");
+
+    registry.remove(first);
+    expect(registry.find("Buenos Aires") && registry.find("Buenos Aires")->handle == second, "removing the first promotes the next");
+    registry.remove(third);
+    expect(registry.find("Buenos Aires")->handle == second, "removing the last keeps the first");
+    CityHandle fourth = registry.add(City("Buenos Aires", -56.0, -32.0));
+    registry.remove(second);
+    expect(registry.find("Buenos Aires") && registry.find("Buenos Aires")->handle == fourth, "a city added after removals joins the chain");
+    registry.remove(fourth);
+    expect(registry.find("Buenos Aires") == nullptr, "the name is gone once every city with it is removed");
+
+    // Removing from the middle of a chain, then re-adding into a reused slot
+    CityHandle a = registry.add(City("Lima", -77.0428, -12.0464));
+    CityHandle b = registry.add(City("Lima", -77.0, -12.0));
+    CityHandle c = registry.add(City("Lima", -76.0, -11.0));
+    registry.remove(b);
+    expect(registry.find("Lima")->handle == a, "removing the middle keeps the first");
+    registry.remove(a);
+    expect(registry.find("Lima")->handle == c, "the chain skips the removed middle");
+    CityHandle d = registry.add(City("Lima", -75.0, -10.0));
+    registry.remove(c);
+    expect(registry.find("Lima")->handle == d, "the city in the reused slot is found");
+
+    registry.clear();
+    expect(registry.empty() && registry.find("Madrid") == nullptr && registry.find("Lima") == nullptr, "clear empties the index");
+    CityHandle again = registry.add(City("Madrid", -3.7038, 40.4168));
+    expect(registry.find("Madrid")->handle == again, "a cleared name can be added again");
+}
+
+// Worker threads deliver to handles taken from a shared list while the UI thread adds, removes and
+// collects, as fetch jobs do while the list is edited mid-batch
+void testConcurrentDelivery() {
+    CityRegistry registry;
+    std::shared_ptr<CancellationToken> token = std::make_shared<CancellationToken>();
+    std::mutex handlesMutex; // Stands in for the pool's queue, which hands handles to workers
+    std::vector<CityHandle> handles;
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> accepted(0);
+
+    for (int i = 0; i < 64; i++) {
+        handles.push_back(registry.add(City("City " + std::to_string(i), 0.0, 0.0)));
+    }
+    std::vector<std::thread> workers;
+    for (int w = 0; w < stress_workers; w++) {
+        workers.emplace_back([&, w]() {
+            std::mt19937 rng(static_cast<unsigned>(w + 1));
+            while (!stop) {
+                CityHandle handle;
+                {
+                    std::lock_guard<std::mutex> lock(handlesMutex);
+                    handle = handles[rng() % handles.size()];
+                }
+                if (registry.deliverWeather(handle, weatherFor(handle), token)) {
+                    accepted++;
+                }
+            }
+            });
+    }
+
+    std::mt19937 rng(99);
+    size_t applied = 0;
+    size_t named = 64;
+    for (int round = 0; round < stress_rounds || accepted < stress_min_deliveries; round++) {
+        size_t pick = rng() % handles.size();
+        CityHandle handle;
+        {
+            std::lock_guard<std::mutex> lock(handlesMutex);
+            handle = handles[pick];
+        }
+        if (rng() % 2 == 0 && registry.remove(handle)) {
+            CityHandle added = registry.add(City("City " + std::to_string(named++), 0.0, 0.0));
+            std::lock_guard<std::mutex> lock(handlesMutex);
+            handles[pick] = added; // Workers may still hold the old handle
+        }
+        applied += registry.collectWeather();
+        if (round % 1000 == 0) {
+            for (const auto& city : registry) {
+                if (city.weatherData.valid && !hasWeatherFor(city)) {
+                    expect(false, "a city received a result meant for another");
+                    break;
+                }
+            }
+        }
+    }
+    stop = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    applied += registry.collectWeather();
+
+    size_t live = 0;
+    bool allOwn = true;
+    for (const auto& city : registry) {
+        live++;
+        allOwn = allOwn && (!city.weatherData.valid || hasWeatherFor(city));
+    }
+    expect(allOwn, "every applied result belongs to the city it landed on");
+    expect(live == 64 && registry.size() == 64, "the registry keeps the cities it should");
+    expect(applied > 0 && applied <= accepted, "results were delivered and applied at most once each");
+    std::printf("Concurrent delivery: %zu accepted, %zu applied\n", accepted.load(), applied);
+}
+
+}
+
+int main() {
+    testStaleHandles();
+    testSlotReuse();
+    testCancelledTokens();
+    testDuplicateNames();
+    testConcurrentDelivery();
+    return finishChecks("City registry");
+}
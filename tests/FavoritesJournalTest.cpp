@@ -0,0 +1,183 @@
+// Favorites Journal Test: Changes journalled after a crash cut off the journal's last line survive the
+// next load, and a complete journal is replayed as written. Works on favorites.txt and favorites.journal
+// in the current directory (CMake runs it in a directory of its own). A name-only favorite whose lookup
+// gets no answer (the API is pointed at a closed port) or is cancelled is kept, in memory and on disk;
+// only a definite miss journals its removal.
+// Usage: favorites_journal_test
+#include "MusaWeatherApp.h"
+#include "TestCheck.h"
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <iterator>
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+void appendFile(const std::string& path, const std::string& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    file << bytes;
+}
+
+void removeFiles() {
+    std::remove(favorites_file.c_str());
+    std::remove(favorites_journal_file.c_str());
+}
+
+// Function to Load the Favorites into a fresh registry, as startup does
+std::set<std::string> load(CityRegistry& registry) {
+    std::set<std::string> favorites;
+    loadMyCityList(registry, favorites);
+    return favorites;
+}
+
+// Function to Add a City to My List and journal it, as "Add to My List" does
+void addFavorite(CityRegistry& registry, std::set<std::string>& favorites, const City& place) {
+    CityHandle handle = registry.add(place);
+    favorites.insert(place.name);
+    journalFavorites(std::vector<const City*>(1, registry.get(handle)), std::vector<std::string>(), registry, favorites);
+}
+
+void testAppendAfterCutOffRecord() {
+    removeFiles();
+    CityRegistry registry;
+    std::set<std::string> favorites;
+    registry.add(City("London", -0.1276, 51.5074));
+    favorites.insert("London");
+    saveMyCityList(registry, favorites);
+    addFavorite(registry, favorites, City("Berlin", 13.4050, 52.5200));
+    appendFile(favorites_journal_file, "+\tMadr"); // The crash: a record written only in part
+
+    CityRegistry reloaded;
+    favorites = load(reloaded);
+    expect(favorites.size() == 2 && favorites.count("London") && favorites.count("Berlin"), "the complete records are replayed");
+    expect(favorites.count("Madr") == 0 && !reloaded.find("Madr"), "the cut-off record is ignored");
+    std::string journal = readFile(favorites_journal_file);
+    expect(!journal.empty() && journal[journal.size() - 1] == '\n', "the cut-off record is cut from the journal");
+
+    addFavorite(reloaded, favorites, City("Paris", 2.3522, 48.8566));
+    CityRegistry again;
+    favorites = load(again);
+    expect(favorites.size() == 3 && favorites.count("Paris"), "a favorite added after the crash survives the next load");
+    const City* paris = again.find("Paris");
+    expect(paris && !paris->geocodePending && paris->lat == 48.8566 && paris->lon == 2.3522, "its location is replayed intact");
+}
+
+// A crash during the very first append can leave only part of the header
+void testCutOffHeader() {
+    removeFiles();
+    CityRegistry registry;
+    std::set<std::string> favorites;
+    registry.add(City("Tokyo", 139.6917, 35.6895));
+    favorites.insert("Tokyo");
+    saveMyCityList(registry, favorites);
+    appendFile(favorites_journal_file, favorites_journal_header.substr(0, 10));
+
+    CityRegistry reloaded;
+    favorites = load(reloaded);
+    addFavorite(reloaded, favorites, City("Seoul", 126.9780, 37.5665));
+    CityRegistry again;
+    favorites = load(again);
+    expect(favorites.size() == 2 && favorites.count("Tokyo") && favorites.count("Seoul"), "a record appended after a cut-off header is replayed");
+}
+
+void testCompleteJournal() {
+    removeFiles();
+    CityRegistry registry;
+    std::set<std::string> favorites;
+    registry.add(City("Rome", 12.4964, 41.9028));
+    favorites.insert("Rome");
+    saveMyCityList(registry, favorites);
+    addFavorite(registry, favorites, City("Lima", -77.0428, -12.0464));
+    favorites.erase("Rome");
+    journalFavorites(std::vector<const City*>(), std::vector<std::string>(1, "Rome"), registry, favorites);
+    std::string before = readFile(favorites_journal_file);
+
+    CityRegistry reloaded;
+    favorites = load(reloaded);
+    expect(favorites.size() == 1 && favorites.count("Lima"), "adds and removes are replayed in order");
+    expect(readFile(favorites_journal_file) == before, "a complete journal is left as it is");
+    expect(favoritesJournalRecords == 2, "the replayed records are counted toward compaction");
+}
+
+// Function to Wait for Every Lookup, applying results each "frame" as main.cpp does
+void applyAll(std::map<std::string, GeocodeJob>& lookups, CityRegistry& registry, std::set<std::string>& favorites) {
+    std::map<std::string, bool> selected;
+    while (!lookups.empty()) {
+        applyFavoriteLookups(lookups, registry, favorites, selected);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+void testFailedLookupKeepsFavorite() {
+    removeFiles();
+    {
+        std::ofstream legacy(favorites_file);
+        legacy << "Atlantis\n"; // Old format: a name with no location
+    }
+    apiClientPool.setHost("http://127.0.0.1:1"); // Nothing listens there: every attempt is a transport error
+    apiRateLimiter.setRate(1e9);
+
+    CityRegistry registry;
+    std::set<std::string> favorites;
+    std::map<std::string, GeocodeJob> lookups = loadMyCityList(registry, favorites);
+    expect(lookups.size() == 1, "the name-only favorite is looked up");
+    applyAll(lookups, registry, favorites);
+    expect(favorites.count("Atlantis") == 1, "a failed lookup keeps the favorite");
+    expect(readFile(favorites_journal_file).find("-\tAtlantis") == std::string::npos, "a failed lookup journals no removal");
+    expect(!geocodeMisses.contains("Atlantis"), "a failed lookup is not remembered as a miss");
+
+    CityRegistry reloaded;
+    favorites = load(reloaded);
+    const City* atlantis = reloaded.find("Atlantis");
+    expect(favorites.count("Atlantis") == 1 && atlantis && atlantis->geocodePending, "the next start looks it up again");
+}
+
+void testOnlyDefiniteMissJournalsRemoval() {
+    removeFiles();
+    CityRegistry registry;
+    std::set<std::string> favorites;
+    City pending("Lemuria", 0.0, 0.0);
+    pending.geocodePending = true;
+    registry.add(pending);
+    registry.add(City("El Dorado", 0.0, 0.0));
+    favorites.insert("Lemuria");
+    favorites.insert("El Dorado");
+    saveMyCityList(registry, favorites);
+
+    // A lookup cancelled before it ran finishes without an answer
+    std::map<std::string, GeocodeJob> lookups;
+    WorkerPool pool(1);
+    std::mutex gate;
+    std::unique_lock<std::mutex> hold(gate);
+    pool.submit([&gate]() { std::lock_guard<std::mutex> wait(gate); }); // Keeps the lookup queued until cancelled
+    lookups["Lemuria"] = AsyncJob<GeocodeResult>::start(pool, [](const std::shared_ptr<CancellationToken>&) {
+        GeocodeResult place = { true, "Lemuria", 1.0, 2.0 };
+        return place;
+        });
+    lookups["Lemuria"]->cancel(cancelPool);
+    hold.unlock();
+    GeocodeResult unknown = { false, "El Dorado", 0.0, 0.0 };
+    lookups["El Dorado"] = AsyncJob<GeocodeResult>::completed(unknown); // The API answered with no match
+    applyAll(lookups, registry, favorites);
+
+    std::string journal = readFile(favorites_journal_file);
+    expect(favorites.count("Lemuria") == 1 && journal.find("Lemuria") == std::string::npos, "a cancelled lookup changes nothing");
+    expect(favorites.count("El Dorado") == 0 && journal.find("-\tEl Dorado\n") != std::string::npos, "a definite miss journals the removal");
+}
+
+}
+
+int main() {
+    testAppendAfterCutOffRecord();
+    testCutOffHeader();
+    testCompleteJournal();
+    testFailedLookupKeepsFavorite();
+    testOnlyDefiniteMissJournalsRemoval();
+    removeFiles();
+    return finishChecks("Favorites journal");
+}
@@ -0,0 +1,86 @@
+// Gazetteer Find Test: find() and normalize() on a synthetic index with a few real-looking rows mixed in,
+// added the way gazetteer_import adds them (the ASCII name as an alternate): exact, case-folded,
+// accented and alternate-name hits, the most populous of several places sharing a name, and misses.
+// Usage: gazetteer_find_test
+#include "Gazetteer.h"
+#include "SyntheticGazetteer.h"
+#include "TestCheck.h"
+#include <cstdio>
+
+namespace {
+
+const size_t synthetic_places = 20000;
+
+Gazetteer::Source row(const char* name, const char* asciiName, uint32_t population, uint32_t geonameId,
+    std::vector<std::string> alternates = std::vector<std::string>()) {
+    Gazetteer::Source source;
+    source.place.name = name;
+    source.place.country = "XX";
+    source.place.lat = 10.0;
+    source.place.lon = 20.0;
+    source.place.population = population;
+    source.place.geonameId = geonameId;
+    source.alternateNames.push_back(asciiName);
+    source.alternateNames.insert(source.alternateNames.end(), alternates.begin(), alternates.end());
+    return source;
+}
+
+// geonameId of the place find() resolves `name` to, or 0 for a miss
+uint32_t found(const Gazetteer& gazetteer, const char* name) {
+    Gazetteer::Place place;
+    return gazetteer.find(name, place) ? place.geonameId : 0;
+}
+
+}
+
+int main() {
+    expect(Gazetteer::normalize("  Rio  de\tJaneiro \n") == "rio de janeiro", "normalize trims, collapses and lowercases");
+    expect(Gazetteer::normalize("S\xC3\xA3o Paulo") == "s\xC3\xA3o paulo", "normalize keeps UTF-8 bytes as they are");
+    expect(Gazetteer::normalize(" \t ").empty(), "normalize of blanks is empty");
+
+    std::vector<Gazetteer::Source> sources = syntheticPlaces(synthetic_places, 5);
+    sources.push_back(row("S\xC3\xA3o Paulo", "Sao Paulo", 12300000, 900001));
+    sources.push_back(row("New York City", "New York City", 8800000, 900002, { "New York", "NYC", "Big Apple" }));
+    sources.push_back(row("Z\xC3\xBCrich", "Zurich", 420000, 900003, { "Zuerich" }));
+    sources.push_back(row("Springfield", "Springfield", 170000, 900004));
+    sources.push_back(row("Springfield", "Springfield", 115000, 900005, { "Springfield Town" }));
+
+    Gazetteer gazetteer;
+    expect(found(gazetteer, "New York") == 0, "a closed gazetteer finds nothing");
+    const std::string path = "gazetteer_find_test.bin";
+    if (!Gazetteer::write(path, sources) || !gazetteer.open(path)) {
+        std::fprintf(stderr, "Could not write and open %s\n", path.c_str());
+        return 1;
+    }
+
+    expect(found(gazetteer, "S\xC3\xA3o Paulo") == 900001, "exact name");
+    expect(found(gazetteer, "New York City") == 900002, "exact name with spaces");
+    expect(found(gazetteer, "  NEW   york\tcity ") == 900002, "case and whitespace are folded");
+    expect(found(gazetteer, "S\xC3\xA3O PAULO") == 900001, "accented name, ASCII letters case-folded");
+    expect(found(gazetteer, "z\xC3\xBCrich") == 900003, "accented name in lower case");
+    expect(found(gazetteer, "Sao Paulo") == 900001, "the ASCII name finds the accented place");
+    expect(found(gazetteer, "zurich") == 900003, "the ASCII name, case-folded");
+    expect(found(gazetteer, "nyc") == 900002, "alternate name");
+    expect(found(gazetteer, "Big Apple") == 900002, "alternate name with a space");
+    expect(found(gazetteer, "Zuerich") == 900003, "alternate spelling");
+    expect(found(gazetteer, "springfield") == 900004, "the most populous of places sharing a name");
+    expect(found(gazetteer, "Springfield Town") == 900005, "an alternate name only the smaller place has");
+
+    expect(found(gazetteer, "Atlantis") == 0, "unknown name misses");
+    expect(found(gazetteer, "New Yor") == 0, "a prefix of a name misses");
+    expect(found(gazetteer, "New York City Hall") == 0, "a name extending a known one misses");
+    expect(found(gazetteer, "Zurich ") == 900003 && found(gazetteer, "Zu rich") == 0, "inner spaces count, outer ones do not");
+    expect(found(gazetteer, "") == 0 && found(gazetteer, "   ") == 0, "an empty name misses");
+
+    // Every synthetic place is found under its own name, unless a more populous place shares it
+    size_t missed = 0;
+    for (size_t i = 0; i < synthetic_places; i += 7) {
+        Gazetteer::Place place;
+        if (!gazetteer.find(sources[i].place.name, place) || place.population < sources[i].place.population) {
+            missed++;
+        }
+    }
+    expect(missed == 0, "synthetic places are found by name");
+
+    return finishChecks("Gazetteer find");
+}
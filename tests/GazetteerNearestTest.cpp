@@ -0,0 +1,95 @@
+// Gazetteer Nearest Test: nearest() against a brute-force scan over every place, for random points
+// (poles and the date line included) on a synthetic index, or on the index given as the argument.
+// Usage: gazetteer_nearest_test [gazetteer.bin]
+#include "Gazetteer.h"
+#include "SyntheticGazetteer.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+const size_t synthetic_places = 50000;
+const size_t query_points = 2000;
+
+// Gazetteer with its place table readable, for the scan
+class ScannableGazetteer : public Gazetteer {
+public:
+    using Gazetteer::placeAt;
+};
+
+struct Point {
+    double xyz[3];
+};
+
+Point unitVector(double lat, double lon) {
+    const double radians = 3.14159265358979323846 / 180.0;
+    Point point = { { std::cos(lat * radians) * std::cos(lon * radians), std::cos(lat * radians) * std::sin(lon * radians), std::sin(lat * radians) } };
+    return point;
+}
+
+double chordDistance(const Point& a, const Point& b) {
+    double dx = a.xyz[0] - b.xyz[0];
+    double dy = a.xyz[1] - b.xyz[1];
+    double dz = a.xyz[2] - b.xyz[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "gazetteer_nearest_test.bin";
+    if (argc <= 1 && !Gazetteer::write(path, syntheticPlaces(synthetic_places, 3))) {
+        std::fprintf(stderr, "Could not write %s\n", path.c_str());
+        return 1;
+    }
+    ScannableGazetteer gazetteer;
+    if (!gazetteer.open(path)) {
+        std::fprintf(stderr, "Could not open %s\n", path.c_str());
+        return 1;
+    }
+
+    // The index keeps float coordinates, so the scan reads the places back from it
+    std::vector<Gazetteer::Place> places;
+    std::vector<Point> points;
+    for (size_t i = 0; i < gazetteer.placeCount(); i++) {
+        places.push_back(gazetteer.placeAt(static_cast<uint32_t>(i)));
+        points.push_back(unitVector(places.back().lat, places.back().lon));
+    }
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    size_t failures = 0;
+    for (size_t i = 0; i < query_points; i++) {
+        double lat = std::asin(2.0 * unit(rng) - 1.0) * 180.0 / 3.14159265358979323846;
+        double lon = unit(rng) * 360.0 - 180.0;
+        if (i < 4) {
+            lat = i % 2 ? 90.0 : -90.0; // Poles
+            lon = i < 2 ? 180.0 : -180.0;
+        }
+        Gazetteer::Place found;
+        if (!gazetteer.nearest(lat, lon, found)) {
+            std::fprintf(stderr, "nearest(%f, %f) found nothing\n", lat, lon);
+            return 1;
+        }
+        Point query = unitVector(lat, lon);
+        double best = 1e9;
+        size_t closest = 0;
+        for (size_t p = 0; p < points.size(); p++) {
+            double distance = chordDistance(query, points[p]);
+            if (distance < best) {
+                best = distance;
+                closest = p;
+            }
+        }
+        // The k-d tree works in floats; a tie within that precision may go either way
+        double foundDistance = chordDistance(query, unitVector(found.lat, found.lon));
+        if (std::fabs(foundDistance - best) > 1e-5) {
+            std::fprintf(stderr, "nearest(%f, %f): %s at %.7f, brute force %s at %.7f\n", lat, lon,
+                found.name.c_str(), foundDistance, places[closest].name.c_str(), best);
+            failures++;
+        }
+    }
+    std::printf("%zu of %zu points matched the brute-force scan over %zu places\n", query_points - failures, query_points, places.size());
+    return failures == 0 ? 0 : 1;
+}
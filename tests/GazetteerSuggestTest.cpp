@@ -0,0 +1,202 @@
+// Gazetteer Suggest Test: suggest() against a linear scan over every key of a synthetic index. Prefixes
+// of real names must return the most populous places with a name starting with them; prefixes with one
+// typo (nothing starts with them) must return the best place under each prefix one edit away, most
+// populous first, and be marked fuzzy.
+// Usage: gazetteer_suggest_test [queries per path, default 500]
+#include "Gazetteer.h"
+#include "SyntheticGazetteer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <unordered_set>
+
+namespace {
+
+const size_t synthetic_places = 10000;
+const size_t suggestion_limit = 8;
+const char edit_alphabet[] = "abcdefghijklmnopqrstuvwxyz '-"; // The characters suggest() tries in an edit
+
+// Gazetteer with its key table readable, for the scan
+class ScannableGazetteer : public Gazetteer {
+public:
+    using Gazetteer::keyData;
+    using Gazetteer::keyPlace;
+    using Gazetteer::placeAt;
+};
+
+struct Key {
+    std::string text;
+    uint32_t place;
+    uint32_t population;
+};
+
+bool startsWith(const std::string& text, const std::string& prefix) {
+    return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+}
+
+// Distinct places with a key starting with `prefix`, most populous first
+std::vector<uint32_t> scanPrefix(const std::vector<Key>& keys, const std::string& prefix, std::vector<uint32_t>& populations) {
+    std::map<uint32_t, uint32_t> matches;
+    for (const Key& key : keys) {
+        if (startsWith(key.text, prefix)) {
+            matches[key.place] = key.population;
+        }
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> ranked(matches.begin(), matches.end());
+    std::sort(ranked.begin(), ranked.end(), [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+    std::vector<uint32_t> places;
+    populations.clear();
+    for (const auto& match : ranked) {
+        places.push_back(match.first);
+        populations.push_back(match.second);
+    }
+    return places;
+}
+
+// Every prefix one insert, delete, substitution or swap away from `key`, other than `key` itself
+std::unordered_set<std::string> oneEditAway(const std::string& key) {
+    std::unordered_set<std::string> variants;
+    for (size_t i = 0; i <= key.size(); i++) {
+        if (i < key.size()) {
+            variants.insert(key.substr(0, i) + key.substr(i + 1));
+        }
+        if (i + 1 < key.size()) {
+            std::string swapped = key;
+            std::swap(swapped[i], swapped[i + 1]);
+            variants.insert(swapped);
+        }
+        for (const char* c = edit_alphabet; *c; c++) {
+            variants.insert(key.substr(0, i) + *c + key.substr(i));
+            if (i < key.size()) {
+                variants.insert(key.substr(0, i) + *c + key.substr(i + 1));
+            }
+        }
+    }
+    variants.erase(key);
+    variants.erase(std::string());
+    return variants;
+}
+
+// The fuzzy answer by brute force: the best key under each variant (lowest key on a tie, as the index
+// breaks them), then those places by population, lowest place on a tie, without repeats
+std::vector<uint32_t> scanFuzzy(const std::vector<Key>& keys, const std::string& query) {
+    std::unordered_set<std::string> variants = oneEditAway(query);
+    std::map<std::string, size_t> best; // Variant and its best key
+    std::string head;
+    for (size_t k = 0; k < keys.size(); k++) {
+        for (size_t length = query.size() - 1; length <= query.size() + 1; length++) {
+            if (length == 0 || keys[k].text.size() < length) {
+                continue;
+            }
+            head.assign(keys[k].text, 0, length);
+            if (variants.count(head) == 0) {
+                continue;
+            }
+            auto current = best.find(head);
+            if (current == best.end() || keys[k].population > keys[current->second].population) {
+                best[head] = k;
+            }
+        }
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> candidates;
+    for (const auto& entry : best) {
+        candidates.push_back(std::make_pair(keys[entry.second].population, keys[entry.second].place));
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+    std::vector<uint32_t> places;
+    for (const auto& candidate : candidates) {
+        if (places.size() == suggestion_limit) {
+            break;
+        }
+        if (std::find(places.begin(), places.end(), candidate.second) == places.end()) {
+            places.push_back(candidate.second);
+        }
+    }
+    return places;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t queries = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 500;
+    std::vector<Gazetteer::Source> sources = syntheticPlaces(synthetic_places, 9);
+    const std::string path = "gazetteer_suggest_test.bin";
+    ScannableGazetteer gazetteer;
+    if (!Gazetteer::write(path, sources) || !gazetteer.open(path)) {
+        std::fprintf(stderr, "Could not write and open %s\n", path.c_str());
+        return 1;
+    }
+    std::vector<Key> keys(gazetteer.keyCount());
+    for (size_t k = 0; k < keys.size(); k++) {
+        size_t length;
+        const char* data = gazetteer.keyData(k, length);
+        keys[k].text.assign(data, length);
+        keys[k].place = gazetteer.keyPlace(k);
+        keys[k].population = gazetteer.placeAt(keys[k].place).population;
+    }
+
+    std::mt19937 rng(4);
+    size_t prefixQueries = 0;
+    size_t fuzzyQueries = 0;
+    size_t failures = 0;
+    std::vector<uint32_t> populations;
+    for (size_t attempt = 0; (prefixQueries < queries || fuzzyQueries < queries) && attempt < queries * 20; attempt++) {
+        // A prefix of some key, with a random character replaced half the time
+        const std::string& name = keys[rng() % keys.size()].text;
+        std::string query = name.substr(0, 1 + rng() % name.size());
+        if (rng() % 2) {
+            query[rng() % query.size()] = edit_alphabet[rng() % (sizeof(edit_alphabet) - 1)];
+        }
+        query = Gazetteer::normalize(query);
+        if (query.empty()) {
+            continue;
+        }
+
+        bool fuzzy = false;
+        std::vector<Gazetteer::Place> suggestions = gazetteer.suggest(query, suggestion_limit, &fuzzy);
+        std::vector<uint32_t> expected = scanPrefix(keys, query, populations);
+        if (!expected.empty()) {
+            if (prefixQueries == queries) {
+                continue;
+            }
+            prefixQueries++;
+            // Places of equal population may come in either order, so the populations are compared,
+            // and every suggestion must be one of the matches
+            size_t count = std::min(expected.size(), suggestion_limit);
+            bool match = !fuzzy && suggestions.size() == count;
+            for (size_t i = 0; match && i < count; i++) {
+                match = suggestions[i].population == populations[i]
+                    && std::find_if(expected.begin(), expected.end(), [&](uint32_t place) {
+                        return gazetteer.placeAt(place).geonameId == suggestions[i].geonameId; }) != expected.end();
+            }
+            if (!match) {
+                std::fprintf(stderr, "suggest(\"%s\"): %zu suggestions, expected %zu by prefix\n", query.c_str(), suggestions.size(), count);
+                failures++;
+            }
+            continue;
+        }
+
+        if (fuzzyQueries == queries) {
+            continue;
+        }
+        fuzzyQueries++;
+        expected = scanFuzzy(keys, query);
+        bool match = fuzzy == !expected.empty() && suggestions.size() == expected.size();
+        for (size_t i = 0; match && i < expected.size(); i++) {
+            match = suggestions[i].geonameId == gazetteer.placeAt(expected[i]).geonameId;
+        }
+        if (!match) {
+            std::fprintf(stderr, "suggest(\"%s\"): %zu suggestions, expected %zu one edit away\n", query.c_str(), suggestions.size(), expected.size());
+            failures++;
+        }
+    }
+    std::printf("%zu prefix and %zu one-typo queries, %zu differed from the linear scan over %zu keys\n",
+        prefixQueries, fuzzyQueries, failures, keys.size());
+    return failures == 0 && prefixQueries == queries && fuzzyQueries == queries ? 0 : 1;
+}
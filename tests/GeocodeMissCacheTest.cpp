@@ -0,0 +1,82 @@
+// Geocode Miss Cache Test: misses expire after their TTL and when stamped in the future (a clock set
+// backwards), survive a save and load with their original time, and a file with another header is
+// not read. Writes its files to the working directory.
+// Usage: geocode_miss_cache_test
+#include "GeocodeMissCache.h"
+#include "TestCheck.h"
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+
+namespace {
+
+const std::chrono::seconds ttl(3600);
+
+void writeLines(const std::string& path, const std::string& contents) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << contents;
+}
+
+bool fileExists(const std::string& path) {
+    return std::ifstream(path).good();
+}
+
+}
+
+int main() {
+    const std::string path = "geocode_miss_cache_test.txt";
+    std::remove(path.c_str());
+
+    // Lookups go by the normalized name
+    GeocodeMissCache cache(ttl);
+    expect(!cache.contains("Atlantis"), "an empty cache holds nothing");
+    cache.add("  ATLANTIS ");
+    cache.add("El  Dorado");
+    cache.add("");
+    expect(cache.contains("atlantis") && cache.contains("el dorado"), "added names are found, normalized");
+    expect(!cache.contains("Shangri-La"), "other names are not");
+
+    // A zero TTL expires a miss at once
+    GeocodeMissCache noTtl(std::chrono::seconds(0));
+    noTtl.add("Atlantis");
+    expect(!noTtl.contains("Atlantis"), "a miss older than the TTL has expired");
+
+    // Round trip: the misses come back under their original times
+    expect(cache.save(path), "save writes the file");
+    GeocodeMissCache reloaded(ttl);
+    expect(reloaded.load(path), "load reads the file back");
+    expect(reloaded.contains("Atlantis") && reloaded.contains("el dorado"), "misses survive a save and load");
+    const std::string untouched = "geocode_miss_cache_test_unchanged.txt";
+    std::remove(untouched.c_str());
+    expect(reloaded.save(untouched) && !fileExists(untouched), "save skips writing when nothing changed");
+
+    // Expiry on load: past the TTL, or stamped in the future because the clock was set back
+    long long now = static_cast<long long>(std::time(nullptr));
+    std::string header;
+    {
+        std::ifstream saved(path);
+        std::getline(saved, header);
+    }
+    writeLines(path, header + "\n"
+        "fresh\t" + std::to_string(now - ttl.count() + 600) + "\n"
+        "stale\t" + std::to_string(now - ttl.count() - 1) + "\n"
+        "future\t" + std::to_string(now + 3600) + "\n"
+        "no tab\n");
+    GeocodeMissCache aged(ttl);
+    expect(aged.load(path), "load accepts its own header");
+    expect(aged.contains("fresh"), "a miss within the TTL is kept");
+    expect(!aged.contains("stale"), "a miss past the TTL is dropped");
+    expect(!aged.contains("future"), "a miss stamped in the future is dropped");
+    expect(!aged.contains("no tab"), "a malformed line is skipped");
+
+    // A file written by something else is not read
+    writeLines(path, "# MusaWeatherApp favorites v2\nAtlantis\t" + std::to_string(now) + "\n");
+    GeocodeMissCache foreign(ttl);
+    expect(!foreign.load(path), "load rejects a foreign header");
+    expect(!foreign.contains("Atlantis"), "nothing is read from a foreign file");
+    std::remove("geocode_miss_cache_test_missing.txt");
+    expect(!foreign.load("geocode_miss_cache_test_missing.txt"), "load of a missing file fails");
+
+    std::remove(path.c_str());
+    return finishChecks("Geocode miss cache");
+}
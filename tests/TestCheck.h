@@ -0,0 +1,30 @@
+#ifndef TESTCHECK_H
+#define TESTCHECK_H
+
+#include <cstdio>
+
+// Test Check: The pass / fail bookkeeping the check-list tests share. Every test is one executable
+// built from one test file, so the failure count can live in this header.
+namespace {
+
+int failures = 0;
+
+// Function to Check One Condition: report `what` and count a failure when `condition` does not hold
+void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// Function to End a Test: say so when every check passed; returns main's exit code
+int finishChecks(const char* name) {
+    if (failures == 0) {
+        std::printf("%s: all checks passed\n", name);
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+}
+
+#endif // TESTCHECK_H
@@ -0,0 +1,59 @@
+// Weather Cache Test: The cache stays within its capacity and evicts the entry least recently
+// looked up or stored; peek() does not count as a use.
+// Usage: weather_cache_test
+#include "WeatherCache.h"
+#include "TestCheck.h"
+#include <cstdio>
+
+namespace {
+
+WeatherSnapshot snapshotFor(int cityId) {
+    WeatherSnapshot data = {};
+    data.valid = true;
+    data.cityId = cityId;
+    return data;
+}
+
+bool cached(WeatherCache& cache, const char* key) {
+    WeatherSnapshot data;
+    std::chrono::seconds age;
+    return cache.peek(key, data, age);
+}
+
+}
+
+int main() {
+    WeatherCache cache(std::chrono::seconds(600), 3);
+    cache.put("a", snapshotFor(1));
+    cache.put("b", snapshotFor(2));
+    cache.put("c", snapshotFor(3));
+
+    // A lookup makes "a" the most recent, so "b" is the one to go
+    WeatherSnapshot data;
+    expect(cache.get("a", data) == WeatherCache::Lookup::Fresh && data.cityId == 1, "get returns a fresh entry");
+    cache.put("d", snapshotFor(4));
+    expect(cache.stats().entries == 3, "the cache holds at most its capacity");
+    expect(cache.stats().evicted == 1, "one entry was evicted");
+    expect(!cached(cache, "b"), "the least recently used entry is evicted");
+    expect(cached(cache, "a") && cached(cache, "c") && cached(cache, "d"), "the other entries stay");
+
+    // Storing again refreshes an entry; peek does not
+    cache.put("c", snapshotFor(30));
+    cached(cache, "a");
+    cache.put("e", snapshotFor(5));
+    expect(!cached(cache, "a"), "peek does not keep an entry");
+    expect(cache.get("c", data) == WeatherCache::Lookup::Fresh && data.cityId == 30, "put replaces an entry's data");
+
+    // Entries stored with an age past the TTL come back stale
+    cache.put("old", snapshotFor(6), std::chrono::seconds(601));
+    expect(cache.get("old", data) == WeatherCache::Lookup::Stale, "an expired entry is stale");
+    expect(cache.get("missing", data) == WeatherCache::Lookup::Miss, "an absent key is a miss");
+    expect(cache.stats().entries == 3 && cache.stats().evicted == 3, "the capacity holds after several evictions");
+
+    WeatherCache tiny(std::chrono::seconds(600), 0);
+    tiny.put("x", snapshotFor(7));
+    tiny.put("y", snapshotFor(8));
+    expect(tiny.stats().entries == 1 && cached(tiny, "y"), "a zero capacity keeps one entry");
+
+    return finishChecks("Weather cache");
+}
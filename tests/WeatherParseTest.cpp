@@ -0,0 +1,174 @@
+// Weather Parse Test: Every body in tests/corpus goes through the parser the app uses
+// (WeatherSnapshot::parse / parseList) and through a JSON tree read by WeatherSnapshot::fromJson;
+// the two must agree field for field, including on which bodies are not weather data at all.
+// Built with MWA_FAST_WEATHER_PARSER, parse() runs WeatherScanner, so this checks the scanner too.
+// Usage: weather_parse_test <corpus directory>
+#include "WeatherSnapshot.h"
+#ifdef MWA_FAST_WEATHER_PARSER
+#include "WeatherScanner.h"
+#endif
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+bool sameSnapshot(const WeatherSnapshot& a, const WeatherSnapshot& b) {
+    return a.valid == b.valid && a.cityId == b.cityId && a.conditionId == b.conditionId &&
+        std::strcmp(a.icon, b.icon) == 0 && a.description == b.description && a.temperature == b.temperature &&
+        a.humidity == b.humidity && a.windSpeed == b.windSpeed && a.sunrise == b.sunrise && a.sunset == b.sunset &&
+        std::strcmp(a.sunriseText, b.sunriseText) == 0 && std::strcmp(a.sunsetText, b.sunsetText) == 0;
+}
+
+void printSnapshot(const char* label, bool found, const WeatherSnapshot& s) {
+    std::fprintf(stderr, "  %-5s found=%d id=%d condition=%d icon=%s description=\"%s\" temp=%.17g humidity=%d wind=%.17g sunrise=%lld sunset=%lld\n",
+        label, found ? 1 : 0, s.cityId, s.conditionId, s.icon, s.description ? s.description : "(null)", s.temperature, s.humidity,
+        s.windSpeed, static_cast<long long>(s.sunrise), static_cast<long long>(s.sunset));
+}
+
+// Function to Read the Tree Version of a Current-Weather Body; not found if it is not JSON or not weather
+bool treeParse(const std::string& body, WeatherSnapshot& snapshot) {
+    nlohmann::json data = nlohmann::json::parse(body, nullptr, false);
+    if (data.is_discarded()) {
+        return false;
+    }
+    snapshot = WeatherSnapshot::fromJson(data);
+    return snapshot.valid;
+}
+
+// Function to Read the Tree Version of a /group Body: every "list" entry that is weather data
+bool treeParseList(const std::string& body, std::vector<WeatherSnapshot>& snapshots) {
+    nlohmann::json data = nlohmann::json::parse(body, nullptr, false);
+    if (data.is_discarded() || !data.is_object() || !data.contains("list") || !data["list"].is_array()) {
+        return false;
+    }
+    for (const auto& entry : data["list"]) {
+        WeatherSnapshot snapshot = WeatherSnapshot::fromJson(entry);
+        if (snapshot.valid) {
+            snapshots.push_back(snapshot);
+        }
+    }
+    return true;
+}
+
+#ifdef MWA_FAST_WEATHER_PARSER
+size_t scannerHandled = 0; // Bodies WeatherScanner read itself instead of leaving them to the SAX parser
+
+bool sameText(const TextSpan& span, const char* text) {
+    return span.size == std::strlen(text) && (span.size == 0 || std::memcmp(span.data, text, span.size) == 0);
+}
+
+// Function to Check the Raw Scanner Fields Against the Tree, before WeatherSnapshot copies them
+bool checkScanner(const std::string& name, const std::string& body, bool expectedFound, const WeatherSnapshot& expected) {
+    WeatherFields fields = {};
+    WeatherScanner::Result scanned = WeatherScanner::scan(body, fields);
+    if (scanned == WeatherScanner::Unsupported) {
+        return true;
+    }
+    scannerHandled++;
+    bool same = (scanned == WeatherScanner::Parsed) == expectedFound;
+    if (same && expectedFound) {
+        same = fields.hasMain && fields.cityId == expected.cityId && fields.conditionId == expected.conditionId &&
+            sameText(fields.icon, expected.icon) && sameText(fields.description, expected.description) &&
+            fields.temperature == expected.temperature && fields.humidity == expected.humidity &&
+            fields.windSpeed == expected.windSpeed && fields.sunrise == expected.sunrise && fields.sunset == expected.sunset;
+    }
+    if (!same) {
+        std::fprintf(stderr, "%s: WeatherScanner (%s) differs from the JSON tree\n", name.c_str(), WeatherScanner::kernel());
+        printSnapshot("tree", expectedFound, expected);
+        std::fprintf(stderr, "  scan  result=%d id=%lld condition=%lld icon=%.*s description=\"%.*s\" temp=%.17g humidity=%lld wind=%.17g sunrise=%lld sunset=%lld\n",
+            static_cast<int>(scanned), static_cast<long long>(fields.cityId), static_cast<long long>(fields.conditionId),
+            static_cast<int>(fields.icon.size), fields.icon.data ? fields.icon.data : "",
+            static_cast<int>(fields.description.size), fields.description.data ? fields.description.data : "",
+            fields.temperature, static_cast<long long>(fields.humidity), fields.windSpeed,
+            static_cast<long long>(fields.sunrise), static_cast<long long>(fields.sunset));
+    }
+    return same;
+}
+#endif
+
+bool checkWeather(const std::string& name, const std::string& body) {
+    WeatherSnapshot expected = {};
+    bool expectedFound = treeParse(body, expected);
+#ifdef MWA_FAST_WEATHER_PARSER
+    if (!checkScanner(name, body, expectedFound, expected)) {
+        return false;
+    }
+#endif
+    WeatherSnapshot parsed = {};
+    bool parsedFound = WeatherSnapshot::parse(body, parsed);
+    if (parsedFound != expectedFound || (expectedFound && !sameSnapshot(parsed, expected))) {
+        std::fprintf(stderr, "%s: WeatherSnapshot::parse differs from the JSON tree\n", name.c_str());
+        printSnapshot("tree", expectedFound, expected);
+        printSnapshot("parse", parsedFound, parsed);
+        return false;
+    }
+    return true;
+}
+
+bool checkGroup(const std::string& name, const std::string& body) {
+    std::vector<WeatherSnapshot> expected;
+    bool expectedFound = treeParseList(body, expected);
+    std::vector<WeatherSnapshot> parsed;
+    bool parsedFound = WeatherSnapshot::parseList(body, parsed);
+    bool same = parsedFound == expectedFound && parsed.size() == expected.size();
+    for (size_t i = 0; same && i < parsed.size(); i++) {
+        same = sameSnapshot(parsed[i], expected[i]);
+    }
+    if (!same) {
+        std::fprintf(stderr, "%s: WeatherSnapshot::parseList differs from the JSON tree (%zu vs %zu entries)\n",
+            name.c_str(), parsed.size(), expected.size());
+        for (size_t i = 0; i < parsed.size() || i < expected.size(); i++) {
+            WeatherSnapshot none = {};
+            printSnapshot("tree", i < expected.size(), i < expected.size() ? expected[i] : none);
+            printSnapshot("parse", i < parsed.size(), i < parsed.size() ? parsed[i] : none);
+        }
+        return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: weather_parse_test <corpus directory>\n");
+        return 2;
+    }
+    std::string directory = argv[1];
+    std::ifstream index(directory + "/index.txt");
+    if (!index.is_open()) {
+        std::fprintf(stderr, "No index.txt in %s\n", directory.c_str());
+        return 2;
+    }
+    std::string line;
+    size_t bodies = 0;
+    size_t failures = 0;
+    while (std::getline(index, line)) {
+        std::istringstream fields(line);
+        std::string kind, name;
+        if (line.empty() || line[0] == '#' || !(fields >> kind >> name)) {
+            continue;
+        }
+        std::ifstream file(directory + "/" + name, std::ios::binary);
+        if (!file.is_open()) {
+            std::fprintf(stderr, "%s: missing\n", name.c_str());
+            failures++;
+            continue;
+        }
+        std::string body((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        bool passed = kind == "group" ? checkGroup(name, body) : checkWeather(name, body);
+        failures += passed ? 0 : 1;
+        bodies++;
+    }
+    std::printf("%zu of %zu bodies parsed the same as the JSON tree\n", bodies - failures, bodies);
+#ifdef MWA_FAST_WEATHER_PARSER
+    std::printf("WeatherScanner (%s) read %zu of them itself; the rest went to the SAX parser\n", WeatherScanner::kernel(), scannerHandled);
+    if (scannerHandled == 0) {
+        std::fprintf(stderr, "The scanner handled no body at all\n");
+        return 1;
+    }
+#endif
+    return failures == 0 && bodies > 0 ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+// Weather Store Test: records written to the slot file come back after a reload, a slot whose bytes were
+// damaged on disk is rejected while every other slot still loads, and the rejected slot is reused by
+// the next new location. Writes its file to the working directory.
+// Usage: weather_store_test
+#include "WeatherStore.h"
+#include "TestCheck.h"
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+const size_t store_capacity = 8;
+const std::chrono::seconds max_age(3600);
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Flip the bits of one byte in place, as a bad sector or a stray write would
+bool corruptByte(const std::string& path, size_t offset) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    char byte;
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(&byte, 1);
+    byte = static_cast<char>(~byte);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(&byte, 1);
+    return static_cast<bool>(file);
+}
+
+const WeatherStore::Record* findRecord(const std::vector<WeatherStore::Record>& records, const std::string& key) {
+    for (const WeatherStore::Record& record : records) {
+        if (record.key == key) {
+            return &record;
+        }
+    }
+    return nullptr;
+}
+
+}
+
+int main() {
+    const std::string path = "weather_store_test.bin";
+    std::remove(path.c_str());
+    const int64_t now = static_cast<int64_t>(std::time(nullptr));
+    const char* keys[] = { "tokyo", "paris", "cairo", "lima" };
+    const size_t key_count = sizeof(keys) / sizeof(keys[0]);
+
+    {
+        WeatherStore store(path, store_capacity, max_age);
+        expect(store.load().empty(), "a missing file loads no records");
+        for (size_t i = 0; i < key_count; i++) {
+            expect(store.save(keys[i], std::string("snapshot of ") + keys[i], now - static_cast<int64_t>(i)), "save writes a record");
+        }
+    }
+
+    {
+        WeatherStore store(path, store_capacity, max_age);
+        std::vector<WeatherStore::Record> records = store.load();
+        expect(records.size() == key_count, "every saved record loads back");
+        const WeatherStore::Record* paris = findRecord(records, "paris");
+        expect(paris && paris->body == "snapshot of paris" && paris->fetchedAt == now - 1, "a record keeps its body and time");
+    }
+
+    // Damage one byte inside paris's body, well clear of its neighbours' slots
+    std::string bytes = readFile(path);
+    size_t body = bytes.find("snapshot of paris");
+    expect(body != std::string::npos, "the body is stored in the file");
+    size_t sizeBefore = bytes.size();
+    expect(body != std::string::npos && corruptByte(path, body + 3), "the slot file can be damaged");
+
+    {
+        WeatherStore store(path, store_capacity, max_age);
+        std::vector<WeatherStore::Record> records = store.load();
+        expect(findRecord(records, "paris") == nullptr, "the damaged slot is rejected");
+        expect(records.size() == key_count - 1, "every other slot still loads");
+        for (size_t i = 0; i < key_count; i++) {
+            const WeatherStore::Record* record = findRecord(records, keys[i]);
+            expect(record != nullptr || std::string(keys[i]) == "paris", "an undamaged slot loads");
+            expect(!record || record->body == std::string("snapshot of ") + keys[i], "an undamaged slot keeps its body");
+        }
+
+        // The rejected slot is free again: a new location takes it instead of growing the file
+        expect(store.save("oslo", "snapshot of oslo", now), "save after a damaged load");
+    }
+    expect(readFile(path).size() == sizeBefore, "a new location reuses the damaged slot");
+
+    {
+        WeatherStore store(path, store_capacity, max_age);
+        std::vector<WeatherStore::Record> records = store.load();
+        expect(records.size() == key_count && findRecord(records, "oslo") && !findRecord(records, "paris"),
+            "the reused slot loads with its new record");
+    }
+
+    std::remove(path.c_str());
+    return finishChecks("Weather store");
+}
@@ -0,0 +1,114 @@
+// Gazetteer Import: Turns a GeoNames cities dump (e.g. cities15000.txt from
+// https://download.geonames.org/export/dump/) into the binary index the app reads at startup.
+//
+// Usage: gazetteer_import <cities.txt> <gazetteer.bin> [--min-population N] [--no-alternates]
+
+#include "Gazetteer.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// GeoNames "geoname" table columns used here
+const size_t column_geoname_id = 0;
+const size_t column_name = 1;
+const size_t column_ascii_name = 2;
+const size_t column_alternate_names = 3;
+const size_t column_latitude = 4;
+const size_t column_longitude = 5;
+const size_t column_country = 8;
+const size_t column_population = 14;
+const size_t column_count = 19;
+
+std::vector<std::string> split(const std::string& line, char separator) {
+    std::vector<std::string> fields;
+    std::istringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, separator)) {
+        fields.push_back(field);
+    }
+    if (!line.empty() && line.back() == separator) {
+        fields.push_back(std::string());
+    }
+    return fields;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <cities.txt> <gazetteer.bin> [--min-population N] [--no-alternates]" << std::endl;
+        return 1;
+    }
+    unsigned long minPopulation = 0;
+    bool alternates = true;
+    for (int i = 3; i < argc; i++) {
+        if (std::strcmp(argv[i], "--min-population") == 0 && i + 1 < argc) {
+            minPopulation = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--no-alternates") == 0) {
+            alternates = false;
+        }
+        else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::ifstream input(argv[1]);
+    if (!input) {
+        std::cerr << "Failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+    std::vector<Gazetteer::Source> sources;
+    std::string line;
+    size_t lineNumber = 0;
+    size_t skipped = 0;
+    while (std::getline(input, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        std::vector<std::string> fields = split(line, '\t');
+        if (fields.size() < column_count) {
+            skipped++;
+            continue;
+        }
+        unsigned long population = std::strtoul(fields[column_population].c_str(), nullptr, 10);
+        if (population < minPopulation) {
+            continue;
+        }
+        Gazetteer::Source source;
+        source.place.name = fields[column_name];
+        source.place.country = fields[column_country];
+        source.place.lat = std::atof(fields[column_latitude].c_str());
+        source.place.lon = std::atof(fields[column_longitude].c_str());
+        source.place.population = static_cast<uint32_t>(population);
+        source.place.geonameId = static_cast<uint32_t>(std::strtoul(fields[column_geoname_id].c_str(), nullptr, 10));
+        source.alternateNames.push_back(fields[column_ascii_name]); // "Sao Paulo" finds "São Paulo"
+        if (alternates) {
+            for (const auto& alternate : split(fields[column_alternate_names], ',')) {
+                source.alternateNames.push_back(alternate);
+            }
+        }
+        sources.push_back(source);
+    }
+    if (skipped > 0) {
+        std::cerr << "Skipped " << skipped << " of " << lineNumber << " lines that are not GeoNames rows" << std::endl;
+    }
+
+    if (!Gazetteer::write(argv[2], sources)) {
+        std::cerr << "Failed to write " << argv[2] << std::endl;
+        return 1;
+    }
+    Gazetteer check;
+    if (!check.open(argv[2])) {
+        std::cerr << "Wrote " << argv[2] << " but it does not read back" << std::endl;
+        return 1;
+    }
+    std::cout << "Indexed " << check.placeCount() << " places under " << check.keyCount() << " names into " << argv[2] << std::endl;
+    return 0;
+}